@@ -0,0 +1,281 @@
+// benchmarkRecHitKernel: time the per-event rechit loop on synthetic HBHE events
+//
+// usage: benchmarkRecHitKernel [--events N] [--hits N] [--seed S] [--channel-histograms]
+//   --events N    number of events (default 1000)
+//   --hits N      rechits per event on average, at most one per channel (default 5000)
+//   --seed S      random seed of the event generator (default 1)
+//   --channel-histograms   compare the per-channel time histograms instead, see below
+//
+// Three versions run over the same events:
+//   root     the loop of the original MakeTimingMaps: TH1F/TH2F/TProfile2D::Fill
+//            per hit, the 8928 per-channel time TH1F included
+//   scalar   TimingAccumulator::fill called once per hit
+//   batch    the hits copied into a RecHitBatch and TimingAccumulator::fill(batch)
+// and the time per rechit is printed for each, including endEvent().
+//
+// With --channel-histograms only the per-channel time histograms are timed:
+// the 8928 TH1F the MakeTimingMaps constructor used to book (names made by
+// string concatenation, filled through the [ieta+29][iphi-1] arrays) against
+// ChannelTimingStore. For both the construction time, the growth of the peak
+// RSS and the fill time per rechit are printed, so the startup and per-event
+// cost before and after come from the same command.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "TH1.h"
+#include "TH2.h"
+#include "TProfile2D.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/ChannelTimingStore.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/SyntheticEvents.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingAccumulator.h"
+
+namespace {
+  void usage() {
+    fprintf(stderr, "usage: benchmarkRecHitKernel [--events N] [--hits N] [--seed S] [--channel-histograms]\n");
+    exit(1);
+  }
+
+  std::vector<std::vector<SyntheticHit> > makeEvents(int nEvents, int nHits, unsigned int seed) {
+    SyntheticEventGenerator::Config config;
+    config.occupancy = double(nHits)/HBHEChannelMap::nChannels;
+    config.seed = seed;
+    SyntheticEventGenerator generator(config);
+    std::vector<std::vector<SyntheticHit> > events(nEvents);
+    for(auto& event : events) generator.next(event);
+    return events;
+  }
+
+  // the per-channel histograms of the old MakeTimingMaps constructor
+  class ChannelHistograms {
+     public:
+        ChannelHistograms() {
+          TH1::AddDirectory(false);
+          const int depth3Eta[6] = {-28, -27, -16, 16, 27, 28};
+          for(int i = 0; i < 72; ++i){
+            std::string iphi = std::to_string(i+1);
+            for(int j = 0; j < 59; ++j){
+              std::string ieta = std::to_string(j-29);
+              depth1_[j][i] = new TH1F(("Depth1_ieta"+ieta+"_iphi"+iphi).c_str(),("Depth1_ieta"+ieta+"_iphi"+iphi).c_str(),200,-100.0,100.0);
+              depth2_[j][i] = new TH1F(("Depth2_ieta"+ieta+"_iphi"+iphi).c_str(),("Depth2_ieta"+ieta+"_iphi"+iphi).c_str(),200,-100.0,100.0);
+            }
+            for(int j = 0; j < 6; ++j){
+              std::string ieta = std::to_string(depth3Eta[j]);
+              depth3_[j][i] = new TH1F(("Depth3_ieta"+ieta+"_iphi"+iphi).c_str(),("Depth3_ieta"+ieta+"_iphi"+iphi).c_str(),200,-100.0,100.0);
+            }
+          }
+        }
+
+        static int booked() { return 2*59*72 + 6*72; }
+
+        void fill(int ieta, int iphi, int depth, double time) {
+          if(depth == 1) depth1_[ieta+29][iphi-1]->Fill(time);
+          else if(depth == 2) depth2_[ieta+29][iphi-1]->Fill(time);
+          else if(depth == 3){
+            int bin = 0;
+            if(ieta == -27) bin = 1;
+            if(ieta == -16) bin = 2;
+            if(ieta ==  16) bin = 3;
+            if(ieta ==  27) bin = 4;
+            if(ieta ==  28) bin = 5;
+            depth3_[bin][iphi-1]->Fill(time);
+          }
+        }
+
+     private:
+        TH1F *depth1_[59][72];
+        TH1F *depth2_[59][72];
+        TH1F *depth3_[6][72];
+  };
+
+  // the rechit loop of MakeTimingMaps before the histograms moved into plain arrays
+  class RootLoop {
+     public:
+        explicit RootLoop(const TimingAccumulator::Config& config) : config_(config) {
+          TH1::AddDirectory(false);
+          for(int d = 0; d < 3; ++d){
+            std::string depth = std::to_string(d+1);
+            timing_[d] = new TProfile2D(("hHBHETiming_Depth"+depth).c_str(),"",59,-29.5,29.5,72,0.5,72.5, config.timeLow, config.timeHigh,"s");
+            occupancy_[d] = new TH2F(("occupancy_d"+depth).c_str(),"",59,-29.5,29.5,72,0.5,72.5);
+          }
+          hCheckTimingPhi67Plus = new TH1F("hCheckTimingPhi67Plus","",50,-25,25);
+          hCheckTiming66to67P = new TH1F("hCheckTiming66to67P","",50,-25,25);
+          hCorrTiming66to67P = new TH2F("hCorrTiming66to67P","",100,-25,75,100,-25,75);
+          hCorrTimingPhi67Plus = new TH2F("hCorrTimingPhi67Plus","",100,-25,75,100,-25,75);
+          const char *windows[3] = {"IT","OOT1","OOT2"};
+          for(int w = 0; w < 3; ++w){
+            energy_[w] = new TH1F((std::string("hCheckEnergy")+windows[w]).c_str(),"",500,0,1000);
+            energyIp51_[w] = new TH1F((std::string("hCheckEnergy")+windows[w]+"ip51").c_str(),"",300,0,300);
+            energyIp54_[w] = new TH1F((std::string("hCheckEnergy")+windows[w]+"ip54").c_str(),"",300,0,300);
+          }
+        }
+
+        void fill(int ieta, int iphi, int depth, double energy, double time) {
+          // the windows the module had hard-coded
+          bool window[3];
+          window[0] = time > -5 && time < 5;
+          window[1] = time > 6 && time < 12;
+          window[2] = time > 12 && time < 20;
+          for(int w = 0; w < 3; ++w){
+            if(!window[w]) continue;
+            if(ieta < 0 && ieta > -16 && iphi == 51) energyIp51_[w]->Fill(energy);
+            if(ieta < 0 && ieta > -16 && iphi == 54) energyIp54_[w]->Fill(energy);
+            energy_[w]->Fill(energy);
+          }
+
+          if(energy <= config_.energyCut) return;
+
+          if(depth < 1 || depth > 3) return;
+          timing_[depth-1]->Fill(ieta, iphi, time);
+          occupancy_[depth-1]->Fill(ieta, iphi, 1);
+          channelHistograms_.fill(ieta, iphi, depth, time);
+          if(depth == 1 && iphi == 67 && ieta > 0 && ieta <= 16) etas67.push_back(time);
+          if(depth == 1 && iphi == 66 && ieta > 0 && ieta <= 16) etas66.push_back(time);
+        }
+
+        void endEvent() {
+          for(unsigned int i = 0; i < etas67.size(); ++i){
+            for(unsigned int j = i+1; j < etas67.size(); ++j){
+              hCheckTimingPhi67Plus->Fill(etas67[i]-etas67[j]);
+              hCorrTimingPhi67Plus->Fill(etas67[i],etas67[j]);
+            }
+            for(unsigned int j = 0; j < etas66.size(); ++j){
+              hCheckTiming66to67P->Fill(etas67[i]-etas66[j]);
+              hCorrTiming66to67P->Fill(etas67[i],etas66[j]);
+            }
+          }
+          etas66.clear();
+          etas67.clear();
+        }
+
+     private:
+        TimingAccumulator::Config config_;
+        TProfile2D *timing_[3];
+        TH2F *occupancy_[3];
+        TH1F *energy_[3];
+        TH1F *energyIp51_[3];
+        TH1F *energyIp54_[3];
+        TH1F *hCheckTimingPhi67Plus;
+        TH1F *hCheckTiming66to67P;
+        TH2F *hCorrTimingPhi67Plus;
+        TH2F *hCorrTiming66to67P;
+        ChannelHistograms channelHistograms_;
+        std::vector<double> etas67;
+        std::vector<double> etas66;
+  };
+
+  double peakRSSMB() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    // kB on Linux
+    return usage.ru_maxrss/1024.0;
+  }
+
+  template <class F>
+  double constructionMs(F&& construct) {
+    auto start = std::chrono::steady_clock::now();
+    construct();
+    return 1e3*std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  template <class F>
+  double nsPerHit(const std::vector<std::vector<SyntheticHit> >& events, F&& processEvent) {
+    unsigned long nHits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(const auto& event : events){
+      processEvent(event);
+      nHits += event.size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return 1e9*seconds/nHits;
+  }
+}
+
+int main(int argc, char** argv) {
+  int nEvents = 1000;
+  int nHits = 5000;
+  unsigned int seed = 1;
+  bool channelHistograms = false;
+
+  for(int i = 1; i < argc; ++i){
+    std::string arg = argv[i];
+    bool hasValue = i+1 < argc;
+    if(arg == "--events" && hasValue) nEvents = atoi(argv[++i]);
+    else if(arg == "--hits" && hasValue) nHits = atoi(argv[++i]);
+    else if(arg == "--seed" && hasValue) seed = atoi(argv[++i]);
+    else if(arg == "--channel-histograms") channelHistograms = true;
+    else usage();
+  }
+  if(nEvents <= 0 || nHits <= 0 || nHits > HBHEChannelMap::nChannels) usage();
+
+  printf("generating %d events with %d rechits each on average\n", nEvents, nHits);
+  std::vector<std::vector<SyntheticHit> > events = makeEvents(nEvents, nHits, seed);
+
+  TimingAccumulator::Config config;
+
+  if(channelHistograms){
+    // the peak RSS only grows, so the store is made first and each gets the growth it caused
+    double rss = peakRSSMB();
+    std::unique_ptr<ChannelTimingStore> store;
+    double storeMs = constructionMs([&]() { store.reset(new ChannelTimingStore()); });
+    double storeMB = peakRSSMB() - rss;
+    rss = peakRSSMB();
+    std::unique_ptr<ChannelHistograms> histograms;
+    double histogramsMs = constructionMs([&]() { histograms.reset(new ChannelHistograms()); });
+    double histogramsMB = peakRSSMB() - rss;
+
+    // the hits above the energy cut of channels which exist, as the module fills them
+    double histogramsTime = nsPerHit(events, [&](const std::vector<SyntheticHit>& event) {
+      for(const SyntheticHit& hit : event){
+        if(hit.energy <= config.energyCut || HBHEChannelMap::channelIndex(hit.ieta, hit.iphi, hit.depth) < 0) continue;
+        histograms->fill(hit.ieta, hit.iphi, hit.depth, hit.time);
+      }
+    });
+    double storeTime = nsPerHit(events, [&](const std::vector<SyntheticHit>& event) {
+      for(const SyntheticHit& hit : event){
+        if(hit.energy <= config.energyCut) continue;
+        store->fill(hit.ieta, hit.iphi, hit.depth, hit.time);
+      }
+    });
+
+    printf("%-10s %9s %9s %9s\n", "", "book[ms]", "RSS[MB]", "ns/hit");
+    printf("%-10s %9.1f %9.1f %9.1f  (%d TH1F)\n", "TH1F", histogramsMs, histogramsMB, histogramsTime, ChannelHistograms::booked());
+    printf("%-10s %9.1f %9.1f %9.1f\n", "store", storeMs, storeMB, storeTime);
+    return 0;
+  }
+
+  RootLoop root(config);
+  double rootTime = nsPerHit(events, [&](const std::vector<SyntheticHit>& event) {
+    for(const SyntheticHit& hit : event) root.fill(hit.ieta, hit.iphi, hit.depth, hit.energy, hit.time);
+    root.endEvent();
+  });
+
+  TimingAccumulator scalar(config);
+  double scalarTime = nsPerHit(events, [&](const std::vector<SyntheticHit>& event) {
+    for(const SyntheticHit& hit : event) scalar.fill(hit.ieta, hit.iphi, hit.depth, hit.energy, hit.time);
+    scalar.endEvent();
+  });
+
+  TimingAccumulator batched(config);
+  RecHitBatch hits;
+  double batchTime = nsPerHit(events, [&](const std::vector<SyntheticHit>& event) {
+    hits.clear();
+    for(const SyntheticHit& hit : event) hits.push_back(hit.ieta, hit.iphi, hit.depth, hit.energy, hit.time);
+    batched.fill(hits);
+    batched.endEvent();
+  });
+
+  printf("%-8s %8.1f ns/hit\n", "root", rootTime);
+  printf("%-8s %8.1f ns/hit  (%.1fx)\n", "scalar", scalarTime, rootTime/scalarTime);
+  printf("%-8s %8.1f ns/hit  (%.1fx)\n", "batch", batchTime, rootTime/batchTime);
+  return 0;
+}
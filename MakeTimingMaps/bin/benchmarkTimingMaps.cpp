@@ -0,0 +1,210 @@
+// benchmarkTimingMaps: end-to-end throughput of MakeTimingMaps on synthetic HBHE events
+//
+// usage: benchmarkTimingMaps [options]
+//   --events N            events to process (default 2000)
+//   --pool N              distinct events generated and cycled through (default 100)
+//   --occupancy F         probability of a hit per channel and event (default 0.5)
+//   --signal-fraction F   fraction of signal-like hits (default 0.1)
+//   --oot-fraction F      fraction of out-of-time hits (default 0.2)
+//   --offset-spread T     spread of the per-channel time offsets in ns (default 1.5)
+//   --streams N           accumulators filled by N threads and merged, like MakeTimingMapsGlobal (default 1)
+//   --lumi-events N       events per lumi block for the timing summary (default 100)
+//   --no-channel-hists    without the 200-bin time histogram per channel
+//   --pulse-capture       capture the ADC samples of out-of-time hits as well
+//   --output FILE         file the histograms are written to (default benchmarkTimingMaps.root)
+//   --seed S              random seed of the event generator (default 1)
+//
+// No input files are needed: the events come from SyntheticEventGenerator and
+// are generated before anything is timed. The steps timed are
+//   fill      the per-event work of the module: rechits into a RecHitBatch,
+//             TimingAccumulator::fill/endEvent, the pulse capture, and the
+//             per lumi block moments of the timing summary
+//   merge     adding the accumulators of the streams
+//   write     writing everything to FILE, closing included
+//   summary   reading FILE back and the per-channel summaries of the plots
+//             (TimingMapSummary, as drawTimingMapsBatch does)
+// Events/s and ns/hit of the fill, the time of every step and the peak RSS
+// are printed one per line, to be compared between versions of the code.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "TDirectory.h"
+#include "TFile.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/PulseShapeCapture.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/SyntheticEvents.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingAccumulator.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingMapSummary.h"
+
+namespace {
+  void usage() {
+    fprintf(stderr, "usage: benchmarkTimingMaps [--events N] [--pool N] [--occupancy F] [--signal-fraction F]\n"
+                    "                           [--oot-fraction F] [--offset-spread T] [--streams N] [--lumi-events N]\n"
+                    "                           [--no-channel-hists] [--pulse-capture] [--output FILE] [--seed S]\n");
+    exit(1);
+  }
+
+  double peakRSSMB() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    // kilobytes on Linux
+    return usage.ru_maxrss/1024.0;
+  }
+
+  double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // what one stream of the module fills
+  struct Stream {
+    Stream(const TimingAccumulator::Config& config, const PulseShapeCapture::Config* pulseConfig) :
+      timing(config), nHits(0)
+    {
+      timing.setLumiMoments(&lumiMoments);
+      if(pulseConfig) pulses.reset(new PulseShapeCapture(*pulseConfig));
+    }
+
+    TimingAccumulator timing;
+    RecHitBatch hits;
+    ChannelMoments lumiMoments;
+    TimingSummary summary;
+    std::unique_ptr<PulseShapeCapture> pulses;
+    unsigned long nHits;
+  };
+
+  // events stream, stream+nStreams, ... of run 1, lumiEvents events per lumi block
+  void process(Stream& s, const std::vector<std::vector<SyntheticHit> >& pool, int nEvents,
+               int stream, int nStreams, int lumiEvents) {
+    uint32_t lumi = 0;
+    for(int event = stream; event < nEvents; event += nStreams){
+      const uint32_t eventLumi = event/lumiEvents + 1;
+      if(eventLumi != lumi){
+        if(lumi > 0) s.summary.add(1, lumi, s.lumiMoments);
+        s.lumiMoments.clear();
+        lumi = eventLumi;
+      }
+      const std::vector<SyntheticHit>& hits = pool[event % pool.size()];
+      if(s.pulses) s.pulses->beginEvent(1, lumi, event);
+      s.hits.clear();
+      s.hits.reserve(hits.size());
+      for(const SyntheticHit& hit : hits){
+        s.hits.push_back(hit.ieta, hit.iphi, hit.depth, hit.energy, hit.time);
+        if(s.pulses) s.pulses->fill(hit.ieta, hit.iphi, hit.depth, hit.energy, hit.time, hit.auxHBHE, hit.aux);
+      }
+      s.timing.fill(s.hits);
+      s.timing.endEvent();
+      s.nHits += hits.size();
+    }
+    if(lumi > 0) s.summary.add(1, lumi, s.lumiMoments);
+  }
+}
+
+int main(int argc, char** argv) {
+  int nEvents = 2000;
+  int poolSize = 100;
+  int nStreams = 1;
+  int lumiEvents = 100;
+  bool capturePulses = false;
+  std::string output = "benchmarkTimingMaps.root";
+  SyntheticEventGenerator::Config generatorConfig;
+  TimingAccumulator::Config config;
+
+  for(int i = 1; i < argc; ++i){
+    std::string arg = argv[i];
+    bool hasValue = i+1 < argc;
+    if(arg == "--events" && hasValue) nEvents = atoi(argv[++i]);
+    else if(arg == "--pool" && hasValue) poolSize = atoi(argv[++i]);
+    else if(arg == "--occupancy" && hasValue) generatorConfig.occupancy = atof(argv[++i]);
+    else if(arg == "--signal-fraction" && hasValue) generatorConfig.signalFraction = atof(argv[++i]);
+    else if(arg == "--oot-fraction" && hasValue) generatorConfig.ootFraction = atof(argv[++i]);
+    else if(arg == "--offset-spread" && hasValue) generatorConfig.offsetSpread = atof(argv[++i]);
+    else if(arg == "--streams" && hasValue) nStreams = atoi(argv[++i]);
+    else if(arg == "--lumi-events" && hasValue) lumiEvents = atoi(argv[++i]);
+    else if(arg == "--no-channel-hists") config.channelHistograms = false;
+    else if(arg == "--pulse-capture") capturePulses = true;
+    else if(arg == "--output" && hasValue) output = argv[++i];
+    else if(arg == "--seed" && hasValue) generatorConfig.seed = atoi(argv[++i]);
+    else usage();
+  }
+  if(nEvents <= 0 || poolSize <= 0 || nStreams <= 0 || lumiEvents <= 0) usage();
+
+  SyntheticEventGenerator generator(generatorConfig);
+  std::vector<std::vector<SyntheticHit> > pool(std::min(poolSize, nEvents));
+  for(auto& event : pool) generator.next(event);
+  const double generatedRSS = peakRSSMB();
+
+  PulseShapeCapture::Config pulseConfig;
+  std::vector<std::unique_ptr<Stream> > streams;
+  for(int s = 0; s < nStreams; ++s) streams.emplace_back(new Stream(config, capturePulses ? &pulseConfig : nullptr));
+
+  auto start = std::chrono::steady_clock::now();
+  if(nStreams == 1) process(*streams[0], pool, nEvents, 0, 1, lumiEvents);
+  else {
+    std::vector<std::thread> threads;
+    for(int s = 0; s < nStreams; ++s){
+      threads.emplace_back(process, std::ref(*streams[s]), std::cref(pool), nEvents, s, nStreams, lumiEvents);
+    }
+    for(auto& t : threads) t.join();
+  }
+  const double fillTime = secondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  Stream& merged = *streams[0];
+  for(int s = 1; s < nStreams; ++s){
+    merged.timing.merge(streams[s]->timing);
+    merged.summary.merge(streams[s]->summary);
+    if(merged.pulses) merged.pulses->merge(*streams[s]->pulses);
+    merged.nHits += streams[s]->nHits;
+  }
+  const double mergeTime = secondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  {
+    TFile out(output.c_str(), "RECREATE");
+    if(out.IsZombie()){
+      fprintf(stderr, "benchmarkTimingMaps: cannot create %s\n", output.c_str());
+      return 1;
+    }
+    TDirectory *dir = out.mkdir("timingMaps");
+    merged.timing.write(dir);
+    merged.summary.write(dir);
+    if(merged.pulses) merged.pulses->write(dir);
+    out.Write();
+    out.Close();
+  }
+  const double writeTime = secondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  {
+    std::unique_ptr<TFile> in(TFile::Open(output.c_str()));
+    TDirectory *dir = in ? (TDirectory*)in->Get("timingMaps") : nullptr;
+    TimingMapSummary::Input maps;
+    if(!dir || !TimingMapSummary::read(dir, maps)){
+      fprintf(stderr, "benchmarkTimingMaps: cannot read the maps back from %s\n", output.c_str());
+      return 1;
+    }
+    TimingMapSummary summary;
+    summary.fill(maps);
+  }
+  const double summaryTime = secondsSince(start);
+
+  printf("events          %d\n", nEvents);
+  printf("hits            %lu\n", merged.nHits);
+  printf("streams         %d\n", nStreams);
+  printf("fill            %8.3f s  %10.1f events/s  %8.1f ns/hit\n", fillTime, nEvents/fillTime, 1e9*fillTime/merged.nHits);
+  printf("merge           %8.3f s\n", mergeTime);
+  printf("write           %8.3f s\n", writeTime);
+  printf("summary         %8.3f s\n", summaryTime);
+  printf("peak RSS        %8.1f MB  (%.1f MB with the generated events only)\n", peakRSSMB(), generatedRSS);
+  return 0;
+}
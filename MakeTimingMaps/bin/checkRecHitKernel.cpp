@@ -0,0 +1,152 @@
+// checkRecHitKernel: the batched rechit fill must give exactly what the per-hit fill gives
+//
+// usage: checkRecHitKernel [--events N] [--hits N] [--seed S]
+//   --events N    number of events (default 200)
+//   --hits N      rechits per event on average, at most one per channel (default 5000)
+//   --seed S      random seed of the event generator (default 1)
+//
+// Runs the same synthetic events (SyntheticEvents.h) through
+// TimingAccumulator::fill once per hit and through fill(RecHitBatch), and
+// compares every histogram write() makes bin by bin (content, error), with
+// the entries and the statistics, as well as the hit counters. Every event
+// also gets a few hits of channels which do not exist. This is done with the
+// default spectra and with one group per iphi slice 49-56 in HB minus, where
+// many hits go into selected groups. Exits with 1 at the first difference.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "TH1.h"
+#include "TList.h"
+#include "TMemFile.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/SyntheticEvents.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingAccumulator.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingInstrumentation.h"
+
+namespace {
+  void usage() {
+    fprintf(stderr, "usage: checkRecHitKernel [--events N] [--hits N] [--seed S]\n");
+    exit(1);
+  }
+
+  // hits which must be dropped by the maps but still go into the spectra of all channels
+  void addBadHits(std::vector<SyntheticHit>& event) {
+    SyntheticHit bad[3] = {{0, 10, 1, 20.f, 1.f, 0, 0}, {5, 10, 4, 20.f, 8.f, 0, 0}, {30, 73, 1, 20.f, 15.f, 0, 0}};
+    for(const SyntheticHit& hit : bad) event.push_back(hit);
+  }
+
+  bool sameCounters(const TimingHitCounters& a, const TimingHitCounters& b) {
+    if(a.hits != b.hits || a.passing != b.passing || a.windowHits != b.windowHits) return false;
+    for(int d = 0; d < 3; ++d) if(a.passingDepth[d] != b.passingDepth[d]) return false;
+    return true;
+  }
+
+  // false and a message at the first difference
+  bool sameHistograms(TDirectory* a, TDirectory* b) {
+    TIter next(a->GetList());
+    TObject *object;
+    int n = 0;
+    while((object = next())){
+      TH1 *ha = dynamic_cast<TH1*>(object);
+      if(!ha) continue;
+      TH1 *hb = dynamic_cast<TH1*>(b->GetList()->FindObject(ha->GetName()));
+      if(!hb || hb->GetNcells() != ha->GetNcells()){
+        printf("  %s: missing or binned differently in the batch output\n", ha->GetName());
+        return false;
+      }
+      for(int bin = 0; bin < ha->GetNcells(); ++bin){
+        if(ha->GetBinContent(bin) != hb->GetBinContent(bin) || ha->GetBinError(bin) != hb->GetBinError(bin)){
+          printf("  %s bin %d: %g +- %g per hit, %g +- %g batched\n", ha->GetName(), bin, ha->GetBinContent(bin),
+                 ha->GetBinError(bin), hb->GetBinContent(bin), hb->GetBinError(bin));
+          return false;
+        }
+      }
+      // sum of w, w^2, wx, wx^2, ... as kept by TH1, at most 13 of them (TProfile2D)
+      double sa[13] = {0}, sb[13] = {0};
+      ha->GetStats(sa);
+      hb->GetStats(sb);
+      bool sameStats = ha->GetEntries() == hb->GetEntries();
+      for(int i = 0; i < 13; ++i) sameStats = sameStats && sa[i] == sb[i];
+      if(!sameStats){
+        printf("  %s: entries or statistics differ\n", ha->GetName());
+        return false;
+      }
+      ++n;
+    }
+    if(n != b->GetList()->GetSize()){
+      printf("  %d histograms per hit, %d batched\n", n, b->GetList()->GetSize());
+      return false;
+    }
+    printf("  %d histograms identical\n", n);
+    return true;
+  }
+
+  bool check(const char* name, const TimingAccumulator::Config& config, const std::vector<std::vector<SyntheticHit> >& events) {
+    printf("%s\n", name);
+    TimingHitCounters scalarCounters, batchCounters;
+    TimingAccumulator scalar(config), batched(config);
+    scalar.setCounters(&scalarCounters);
+    batched.setCounters(&batchCounters);
+
+    RecHitBatch hits;
+    for(const auto& event : events){
+      for(const SyntheticHit& hit : event) scalar.fill(hit.ieta, hit.iphi, hit.depth, hit.energy, hit.time);
+      scalar.endEvent();
+
+      hits.clear();
+      for(const SyntheticHit& hit : event) hits.push_back(hit.ieta, hit.iphi, hit.depth, hit.energy, hit.time);
+      batched.fill(hits);
+      batched.endEvent();
+    }
+
+    if(!sameCounters(scalarCounters, batchCounters)){
+      printf("  hit counters differ\n");
+      return false;
+    }
+    TMemFile scalarFile("scalar.root", "RECREATE"), batchFile("batch.root", "RECREATE");
+    scalar.write(&scalarFile);
+    batched.write(&batchFile);
+    return sameHistograms(&scalarFile, &batchFile);
+  }
+}
+
+int main(int argc, char** argv) {
+  int nEvents = 200;
+  int nHits = 5000;
+  unsigned int seed = 1;
+
+  for(int i = 1; i < argc; ++i){
+    std::string arg = argv[i];
+    bool hasValue = i+1 < argc;
+    if(arg == "--events" && hasValue) nEvents = atoi(argv[++i]);
+    else if(arg == "--hits" && hasValue) nHits = atoi(argv[++i]);
+    else if(arg == "--seed" && hasValue) seed = atoi(argv[++i]);
+    else usage();
+  }
+  if(nEvents <= 0 || nHits <= 0 || nHits > HBHEChannelMap::nChannels) usage();
+
+  SyntheticEventGenerator::Config generatorConfig;
+  generatorConfig.occupancy = double(nHits)/HBHEChannelMap::nChannels;
+  generatorConfig.seed = seed;
+  SyntheticEventGenerator generator(generatorConfig);
+  std::vector<std::vector<SyntheticHit> > events(nEvents);
+  for(auto& event : events){
+    generator.next(event);
+    addBadHits(event);
+  }
+
+  TimingAccumulator::Config config;
+  if(!check("default spectra", config, events)) return 1;
+
+  // like phiSliceSpectra(range(49, 57)) of python/energySpectra_cff.py
+  for(int iphi = 49; iphi < 57; ++iphi){
+    config.spectrumGroups.push_back({"ip"+std::to_string(iphi)+"_ieta-16to-1", false, {{1, 2, 3}, -16, -1, {iphi}}, 300, 0, 300});
+  }
+  if(!check("iphi slice spectra", config, events)) return 1;
+
+  printf("per-hit and batched fill agree\n");
+  return 0;
+}
@@ -0,0 +1,256 @@
+// drawTimingMapsBatch: the plots of TimingAnalysis/drawTimingMaps.C for many runs in one go
+//
+// usage: drawTimingMapsBatch [--jobs N] [--dir timingMaps] [--outdir DIR] run1.root [run2.root ...]
+//   --jobs N       workers printing the PNGs
+//                  (default: number of cores)
+//   --dir D        directory of the MakeTimingMaps histograms (default timingMaps)
+//   --outdir DIR   the plots of runX.root go to DIR/runX/, labelled "runX" (default .)
+//
+// Same plots and file names as the macro. The keys of the histogram directory
+// are read in one pass, and of the per-channel histograms only those of the
+// channels which get an outlier plot are read at all. The PNGs are printed by
+// forked workers (ROOT graphics is not thread-safe) which share the histograms
+// read by the parent. Outputs with the robust time maps of ChannelTimeQuantiles
+// also get _Depth<d>_MedianTime, _IQR and _TruncMeanTime plots. The outputs of
+// mergeTimingMaps already have the channel summaries (channelSummary tree),
+// these are used as they are.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "TCanvas.h"
+#include "TDirectory.h"
+#include "TError.h"
+#include "TFile.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TProfile2D.h"
+#include "TROOT.h"
+#include "TStyle.h"
+#include "TSystem.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingMapSummary.h"
+
+namespace {
+  void usage() {
+    fprintf(stderr, "usage: drawTimingMapsBatch [--jobs N] [--dir timingMaps] [--outdir DIR] run.root [run.root ...]\n");
+    exit(1);
+  }
+
+  // the channels whose time histogram gets printed
+  bool isOutlierChannel(int ieta, int iphi) {
+    return ((iphi==67||iphi==66||iphi==22||iphi==60) && ieta > 0 && ieta < 16) ||
+           ((iphi==51||iphi==54) && ieta < 0 && ieta > -16);
+  }
+
+  const char* partitionTitle[3] = {"Channels with iphi 3-26", "Channels with iphi 27-50", "Channels with iphi 51-72, 1-2"};
+
+  // what the parent prepares and a worker prints
+  struct PlotJob {
+    TH1 *hist;
+    std::string option;
+    bool logy;
+    bool logz;
+    std::string file;
+  };
+
+  void setAxes(TH1* h, const char* x, const char* y, bool stats, const std::string& title) {
+    h->SetStats(stats);
+    h->GetXaxis()->SetTitle(x);
+    h->GetYaxis()->SetTitle(y);
+    h->SetTitle(title.c_str());
+  }
+
+  // list the plots of one run, everything drawn is set up here
+  std::vector<PlotJob> preparePlots(TimingMapSummary::Input& in, TimingMapSummary& s,
+                                    const std::string& label, const std::string& outDir) {
+    std::vector<PlotJob> jobs;
+    for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+      const HBHEChannelMap::Channel& c = HBHEChannelMap::channel(ch);
+      const TimingMapSummary::ChannelStats& st = s.stats()[ch];
+      if(st.time == 0) continue;
+
+      TH1 *h = in.channels[ch];
+      // only channels with entries are written by MakeTimingMaps
+      if(!h) continue;
+      std::stringstream ss;
+      ss << label << " Depth=" << int(c.depth) << " ieta=" << int(c.ieta) << " iphi=" << int(c.iphi) << "  avg.time=" << st.time;
+      h->SetStats(kFALSE);
+      h->SetTitle(ss.str().c_str());
+      jobs.push_back({h, "", false, false, outDir+"/OutlierTimingPlot/Outlier_"+label+"_Depth"+std::to_string(c.depth)+
+                                           "_ieta"+std::to_string(c.ieta)+"_iphi"+std::to_string(c.iphi)+".png"});
+    }
+
+    if(in.corr66to67){
+      setAxes(in.corr66to67, "Hit Time in iphi=67 [ns]", "Hit Time in iphi=66 [ns]", kFALSE, "Timing correlation between rechits in an event");
+      jobs.push_back({in.corr66to67, "colz", false, false, outDir+"/"+label+"_hCorrTiming66to67P.png"});
+    }
+    if(in.corrPhi67Plus){
+      setAxes(in.corrPhi67Plus, "Hit Time in iphi=67 [ns]", "Hit Time in iphi=67 [ns]", kFALSE, "Timing correlation between rechits in an event, same iphi");
+      jobs.push_back({in.corrPhi67Plus, "colz", false, false, outDir+"/"+label+"hCorrTimingPhi67Plus.png"});
+    }
+
+    for(int depth = 0; depth < 3; ++depth){
+      std::string n = std::to_string(depth+1);
+      std::string prefix = outDir+"/"+label;
+
+      setAxes(in.occupancy[depth], "ieta", "iphi", kFALSE, "Occupancy, Depth "+n);
+      jobs.push_back({in.occupancy[depth], "colz", false, true, prefix+"_Depth"+n+"_occupancy.png"});
+
+      setAxes(in.timing[depth], "ieta", "iphi", kFALSE, "HBHE Average Channel Timing, Depth "+n);
+      in.timing[depth]->GetZaxis()->SetRangeUser(-6.0, 6.0);
+      jobs.push_back({in.timing[depth], "colz", false, false, prefix+"_Depth"+n+"_AverageTime.png"});
+
+      setAxes(s.rms[depth].get(), "ieta", "iphi", kFALSE, "HBHE Time RMS, Depth "+n);
+      s.rms[depth]->GetZaxis()->SetRangeUser(0.0, 7.0);
+      jobs.push_back({s.rms[depth].get(), "colz", false, false, prefix+"_Depth"+n+"_RMS.png"});
+
+      setAxes(s.err[depth].get(), "ieta", "iphi", kFALSE, "HBHE Time RMS/sqrt(N), Depth "+n);
+      s.err[depth]->GetZaxis()->SetRangeUser(0.0, 0.4);
+      jobs.push_back({s.err[depth].get(), "colz", false, false, prefix+"_Depth"+n+"_Err.png"});
+
+      if(in.median[depth]){
+        setAxes(in.median[depth], "ieta", "iphi", kFALSE, "HBHE Median Channel Timing, Depth "+n);
+        in.median[depth]->GetZaxis()->SetRangeUser(-6.0, 6.0);
+        jobs.push_back({in.median[depth], "colz", false, false, prefix+"_Depth"+n+"_MedianTime.png"});
+      }
+      if(in.iqr[depth]){
+        setAxes(in.iqr[depth], "ieta", "iphi", kFALSE, "HBHE Time Interquartile Range, Depth "+n);
+        in.iqr[depth]->GetZaxis()->SetRangeUser(0.0, 7.0);
+        jobs.push_back({in.iqr[depth], "colz", false, false, prefix+"_Depth"+n+"_IQR.png"});
+      }
+      if(in.truncMean[depth]){
+        setAxes(in.truncMean[depth], "ieta", "iphi", kFALSE, "HBHE Truncated Mean Channel Timing, Depth "+n);
+        in.truncMean[depth]->GetZaxis()->SetRangeUser(-6.0, 6.0);
+        jobs.push_back({in.truncMean[depth], "colz", false, false, prefix+"_Depth"+n+"_TruncMeanTime.png"});
+      }
+
+      // from here on "depth" is the phi partition, as in the macro
+      setAxes(s.rmsHist[depth].get(), "RMS", "Number of Channels", kTRUE, partitionTitle[depth]);
+      jobs.push_back({s.rmsHist[depth].get(), "colz", false, false, prefix+"_RMS_Partition"+n+".png"});
+
+      setAxes(s.timeHist[depth].get(), "Average Time [ns]", "Number of Channels", kTRUE, partitionTitle[depth]);
+      jobs.push_back({s.timeHist[depth].get(), "", false, false, prefix+"_AverageTime_Partition"+n+".png"});
+
+      setAxes(s.timeHistHB[depth].get(), "Average Time HB [ns]", "Number of Channels", kTRUE, partitionTitle[depth]);
+      jobs.push_back({s.timeHistHB[depth].get(), "", false, false, prefix+"_AverageTimeHB_Partition"+n+".png"});
+
+      setAxes(s.timeHistHE[depth].get(), "Average Time HE [ns]", "Number of Channels", kTRUE, partitionTitle[depth]);
+      jobs.push_back({s.timeHistHE[depth].get(), "", false, false, prefix+"_AverageTimeHE_Partition"+n+".png"});
+    }
+
+    setAxes(s.timeAll.get(), "Average time per channel [ns]", "Number of channels", kFALSE, "Average Time of Individual HBHE Channels");
+    jobs.push_back({s.timeAll.get(), "colz", true, false, outDir+"/"+label+"_timeHist_All.png"});
+    return jobs;
+  }
+
+  // print the jobs with nWorkers forked processes, each taking the next job
+  // from a counter shared with the others; returns the number of failed workers
+  int printPlots(const std::vector<PlotJob>& jobs, int nWorkers) {
+    void *shared = mmap(nullptr, sizeof(std::atomic<unsigned int>), PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    std::atomic<unsigned int> local(0);
+    std::atomic<unsigned int> *next = &local;
+    if(shared == MAP_FAILED) nWorkers = 0;
+    else next = new (shared) std::atomic<unsigned int>(0);
+
+    auto work = [&](const std::string& canvasName) {
+      TCanvas canvas(canvasName.c_str(), canvasName.c_str(), 800, 600);
+      unsigned int j;
+      while((j = next->fetch_add(1)) < jobs.size()){
+        const PlotJob& job = jobs[j];
+        canvas.cd();
+        canvas.SetLogy(job.logy);
+        canvas.SetLogz(job.logz);
+        job.hist->Draw(job.option.c_str());
+        canvas.Print(job.file.c_str());
+        canvas.Clear();
+      }
+    };
+
+    fflush(stdout);
+    fflush(stderr);
+    std::vector<pid_t> workers;
+    for(int w = 0; w < nWorkers; ++w){
+      pid_t pid = fork();
+      if(pid == 0){
+        work("canvas"+std::to_string(w));
+        _exit(0);
+      }
+      if(pid < 0) break;
+      workers.push_back(pid);
+    }
+    // no shared counter or could not fork at all, print here
+    if(workers.empty()) work("canvas");
+
+    int failures = 0;
+    for(pid_t pid : workers){
+      int status;
+      if(waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ++failures;
+    }
+    if(shared != MAP_FAILED) munmap(shared, sizeof(std::atomic<unsigned int>));
+    return failures;
+  }
+}
+
+int main(int argc, char** argv) {
+  int nJobs = std::max(1u, std::thread::hardware_concurrency());
+  std::string dirName = "timingMaps";
+  std::string outBase = ".";
+  std::vector<std::string> files;
+
+  for(int i = 1; i < argc; ++i){
+    std::string arg = argv[i];
+    bool hasValue = i+1 < argc;
+    if(arg == "--jobs" && hasValue) nJobs = atoi(argv[++i]);
+    else if(arg == "--dir" && hasValue) dirName = argv[++i];
+    else if(arg == "--outdir" && hasValue) outBase = argv[++i];
+    else if(arg.compare(0, 2, "--") == 0) usage();
+    else files.push_back(arg);
+  }
+  if(files.empty() || nJobs < 1) usage();
+
+  gROOT->SetBatch(kTRUE);
+  // no "png file has been created" for every plot
+  gErrorIgnoreLevel = kWarning;
+  gStyle->SetPalette(kTemperatureMap);
+
+  int failed = 0;
+  for(const std::string& fileName : files){
+    // run251721.root -> run251721
+    std::string label = fileName.substr(fileName.rfind('/')+1);
+    if(label.size() > 5 && label.compare(label.size()-5, 5, ".root") == 0) label.resize(label.size()-5);
+    std::string outDir = outBase+"/"+label;
+
+    std::unique_ptr<TFile> file(TFile::Open(fileName.c_str()));
+    TDirectory *dir = file && !file->IsZombie() ? (TDirectory*)file->Get(dirName.c_str()) : nullptr;
+    TimingMapSummary::Input in;
+    if(!dir || !TimingMapSummary::read(dir, in, isOutlierChannel)){
+      fprintf(stderr, "drawTimingMapsBatch: no timing maps in %s/%s, skipped\n", fileName.c_str(), dirName.c_str());
+      ++failed;
+      continue;
+    }
+    gSystem->mkdir(outDir.c_str(), true);
+    gSystem->mkdir((outDir+"/OutlierTimingPlot").c_str(), true);
+
+    TimingMapSummary summary;
+    summary.fill(in);
+    std::vector<PlotJob> jobs = preparePlots(in, summary, label, outDir);
+
+    int failures = printPlots(jobs, std::min<int>(nJobs, jobs.size()));
+    if(failures) fprintf(stderr, "drawTimingMapsBatch: %d plot workers failed for %s\n", failures, fileName.c_str());
+    printf("%s: %lu plots in %s\n", fileName.c_str(), (unsigned long)jobs.size(), outDir.c_str());
+    if(failures) ++failed;
+  }
+  return failed ? 1 : 0;
+}
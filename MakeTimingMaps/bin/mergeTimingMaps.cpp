@@ -0,0 +1,207 @@
+// mergeTimingMaps: add up the MakeTimingMaps outputs of many jobs, in parallel
+//
+// usage: mergeTimingMaps [--jobs N] [--dir timingMaps] [--list files.txt] [--table table.txt] output.root [input.root ...]
+//   --jobs N       threads reading the inputs (default: number of cores)
+//   --dir D        directory of the MakeTimingMaps histograms (default timingMaps)
+//   --list F       read the input names from F as well, one per line
+//   --table F      also write the per-channel summary as text to F
+//
+// Replaces hadd for the thousands of outputs of a LumiBased CRAB task. Every
+// thread takes its share of the inputs and adds them one at a time into the
+// plain arrays of a MergedTimingMaps, closing each file before it opens the
+// next, so the memory is bounded by the number of threads and not by the
+// number of inputs. The per-thread sums are then added pairwise in
+// log2(threads) rounds. The inputs are split in order, so the same inputs and
+// --jobs give the same output. The merged directory has everything the module
+// writes (maps, per-channel histograms, quantile sketches and robust maps,
+// timing summary, correlations and energy spectra; not the pulse shapes) plus
+// the channelSummary tree of TimingMapSummary: time, RMS, RMS/sqrt(N) and
+// occupancy of every channel, which drawTimingMapsBatch uses instead of
+// computing them again. Inputs which cannot be opened or have no maps are
+// skipped and listed, and make the exit code 1.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TProfile2D.h"
+#include "TROOT.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/MergedTimingMaps.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingMapSummary.h"
+
+namespace {
+  void usage() {
+    fprintf(stderr, "usage: mergeTimingMaps [--jobs N] [--dir timingMaps] [--list files.txt] [--table table.txt] output.root [input.root ...]\n");
+    exit(1);
+  }
+
+  // what one thread read
+  struct Partial {
+    std::unique_ptr<MergedTimingMaps> maps;
+    std::vector<std::string> skipped;
+    std::string error;
+  };
+
+  void readInputs(const std::vector<std::string>& files, unsigned int first, unsigned int last,
+                  const std::string& dirName, Partial& partial) {
+    partial.maps.reset(new MergedTimingMaps());
+    try {
+      for(unsigned int f = first; f < last; ++f){
+        std::unique_ptr<TFile> file(TFile::Open(files[f].c_str()));
+        TDirectory *dir = file && !file->IsZombie() ? (TDirectory*)file->Get(dirName.c_str()) : nullptr;
+        if(!dir || !partial.maps->add(dir)) partial.skipped.push_back(files[f]);
+      }
+    } catch(std::exception& e) {
+      partial.error = e.what();
+    }
+  }
+
+  void writeTable(const std::string& fileName, const std::vector<TimingMapSummary::ChannelStats>& stats) {
+    FILE *out = fopen(fileName.c_str(), "w");
+    if(!out) throw std::runtime_error("cannot open "+fileName+" for writing");
+    fprintf(out, "# depth ieta iphi time rms err occupancy\n");
+    for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+      const TimingMapSummary::ChannelStats& st = stats[ch];
+      if(st.events <= 0) continue;
+      const HBHEChannelMap::Channel& c = HBHEChannelMap::channel(ch);
+      fprintf(out, "%d %d %d %.4f %.4f %.5f %.0f\n", int(c.depth), int(c.ieta), int(c.iphi),
+              st.time, st.rms, st.rms/std::sqrt(st.events), st.events);
+    }
+    bool failed = ferror(out);
+    if(fclose(out) != 0 || failed) throw std::runtime_error("write to "+fileName+" failed");
+  }
+}
+
+int main(int argc, char** argv) {
+  int nJobs = std::max(1u, std::thread::hardware_concurrency());
+  std::string dirName = "timingMaps";
+  std::string tableName;
+  std::vector<std::string> files, listed;
+
+  for(int i = 1; i < argc; ++i){
+    std::string arg = argv[i];
+    bool hasValue = i+1 < argc;
+    if(arg == "--jobs" && hasValue) nJobs = atoi(argv[++i]);
+    else if(arg == "--dir" && hasValue) dirName = argv[++i];
+    else if(arg == "--table" && hasValue) tableName = argv[++i];
+    else if(arg == "--list" && hasValue){
+      std::ifstream list(argv[++i]);
+      if(!list){
+        fprintf(stderr, "mergeTimingMaps: cannot read %s\n", argv[i]);
+        return 1;
+      }
+      std::string name;
+      while(list >> name) listed.push_back(name);
+    }
+    else if(arg.compare(0, 2, "--") == 0) usage();
+    else files.push_back(arg);
+  }
+  files.insert(files.end(), listed.begin(), listed.end());
+  if(files.size() < 2 || nJobs < 1) usage();
+
+  const std::string outName = files[0];
+  files.erase(files.begin());
+  nJobs = std::min<int>(nJobs, files.size());
+
+  // every thread opens its own files; what they read or copy must not be
+  // added to gDirectory, which is the gROOT all threads share
+  ROOT::EnableThreadSafety();
+  TH1::AddDirectory(kFALSE);
+  auto start = std::chrono::steady_clock::now();
+
+  // thread j reads inputs [j*n/nJobs, (j+1)*n/nJobs)
+  std::vector<Partial> partials(nJobs);
+  std::vector<std::thread> threads;
+  for(int j = 0; j < nJobs; ++j){
+    unsigned int first = (unsigned long)j*files.size()/nJobs, last = (unsigned long)(j+1)*files.size()/nJobs;
+    threads.emplace_back(readInputs, std::cref(files), first, last, std::cref(dirName), std::ref(partials[j]));
+  }
+  for(auto& t : threads) t.join();
+
+  int skipped = 0;
+  bool failed = false;
+  for(const Partial& p : partials){
+    for(const std::string& name : p.skipped) fprintf(stderr, "mergeTimingMaps: no timing maps in %s/%s, skipped\n", name.c_str(), dirName.c_str());
+    skipped += p.skipped.size();
+    if(!p.error.empty()){
+      fprintf(stderr, "mergeTimingMaps: %s\n", p.error.c_str());
+      failed = true;
+    }
+  }
+  if(failed) return 1;
+
+  // pairwise: partial j gets partial j+step, the pairs of a round in parallel
+  try {
+    for(int step = 1; step < nJobs; step *= 2){
+      threads.clear();
+      std::vector<std::string> errors(nJobs);
+      for(int j = 0; j+step < nJobs; j += 2*step){
+        threads.emplace_back([&partials, &errors, j, step]() {
+          try {
+            partials[j].maps->merge(*partials[j+step].maps);
+          } catch(std::exception& e) {
+            errors[j] = e.what();
+          }
+          partials[j+step].maps.reset();
+        });
+      }
+      for(auto& t : threads) t.join();
+      for(const std::string& e : errors) if(!e.empty()) throw std::runtime_error(e);
+    }
+  } catch(std::exception& e) {
+    fprintf(stderr, "mergeTimingMaps: %s\n", e.what());
+    return 1;
+  }
+  const MergedTimingMaps& merged = *partials[0].maps;
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  if(merged.inputs() == 0){
+    fprintf(stderr, "mergeTimingMaps: none of the %u inputs has timing maps\n", (unsigned int)files.size());
+    return 1;
+  }
+
+  TFile out(outName.c_str(), "RECREATE");
+  if(out.IsZombie()){
+    fprintf(stderr, "mergeTimingMaps: cannot create %s\n", outName.c_str());
+    return 1;
+  }
+  TDirectory *outDir = out.mkdir(dirName.c_str());
+  merged.write(outDir);
+
+  // the channel statistics of the merged maps, as drawTimingMapsBatch makes them
+  TimingMapSummary::Input in;
+  for(int d = 0; d < 3; ++d){
+    std::string depth = std::to_string(d+1);
+    in.timing[d] = (TProfile2D*)outDir->Get(("hHBHETiming_Depth"+depth).c_str());
+    in.occupancy[d] = (TH2*)outDir->Get(("occupancy_d"+depth).c_str());
+  }
+  TimingMapSummary summary;
+  summary.fill(in);
+  summary.writeTable(outDir);
+  out.Write();
+  out.Close();
+
+  printf("merged %u of %u files with %d threads in %.1f s\n", merged.inputs(), (unsigned int)files.size(), nJobs, seconds);
+  if(!tableName.empty()){
+    try {
+      writeTable(tableName, summary.stats());
+    } catch(std::exception& e) {
+      fprintf(stderr, "mergeTimingMaps: %s\n", e.what());
+      return 1;
+    }
+  }
+  return skipped ? 1 : 0;
+}
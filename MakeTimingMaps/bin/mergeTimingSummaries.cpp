@@ -0,0 +1,97 @@
+// mergeTimingSummaries: add up the timing summaries of many MakeTimingMaps jobs
+//
+// usage: mergeTimingSummaries [--dir timingMaps] [--trend depth,ieta,iphi] output.root input.root [input.root ...]
+//
+// Only the small timingSummary trees are read, so combining the outputs of a
+// LumiBased CRAB task does not need hadd over the per-channel histograms. The
+// merged summary (tree plus per-run mean time maps) is written to the same
+// directory of output.root. The per-channel quantile sketches
+// (hTimeQuantileSketch) are added up as well, and the median/IQR/truncated
+// mean maps made again from the sum. With --trend the mean time of one
+// channel is printed for every run and lumi section.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TDirectory.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/ChannelTimeQuantiles.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingSummary.h"
+
+namespace {
+  void usage() {
+    fprintf(stderr, "usage: mergeTimingSummaries [--dir timingMaps] [--trend depth,ieta,iphi] output.root input.root [input.root ...]\n");
+    exit(1);
+  }
+}
+
+int main(int argc, char** argv) {
+  std::string dirName = "timingMaps";
+  int trendChannel = -1;
+  std::vector<std::string> files;
+
+  for(int i = 1; i < argc; ++i){
+    std::string arg = argv[i];
+    if(arg == "--dir" && i+1 < argc) dirName = argv[++i];
+    else if(arg == "--trend" && i+1 < argc){
+      int depth, ieta, iphi;
+      if(sscanf(argv[++i], "%d,%d,%d", &depth, &ieta, &iphi) != 3) usage();
+      trendChannel = HBHEChannelMap::channelIndex(ieta, iphi, depth);
+      if(trendChannel < 0){
+        fprintf(stderr, "mergeTimingSummaries: no channel depth %d ieta %d iphi %d\n", depth, ieta, iphi);
+        return 1;
+      }
+    }
+    else if(arg.compare(0, 2, "--") == 0) usage();
+    else files.push_back(arg);
+  }
+  if(files.size() < 2) usage();
+
+  TimingSummary summary;
+  ChannelTimeQuantiles quantiles;
+  unsigned int nSketches = 0;
+  try {
+    for(unsigned int f = 1; f < files.size(); ++f){
+      TFile *in = TFile::Open(files[f].c_str());
+      if(!in || in->IsZombie()) throw std::runtime_error("cannot open "+files[f]);
+      TDirectory *dir = (TDirectory*)in->Get(dirName.c_str());
+      if(!dir || !summary.read(dir)) fprintf(stderr, "mergeTimingSummaries: no timing summary in %s, skipped\n", files[f].c_str());
+      if(dir && quantiles.read(dir)) ++nSketches;
+      in->Close();
+      delete in;
+    }
+  } catch(std::exception& e) {
+    fprintf(stderr, "mergeTimingSummaries: %s\n", e.what());
+    return 1;
+  }
+
+  TFile out(files[0].c_str(), "RECREATE");
+  if(out.IsZombie()){
+    fprintf(stderr, "mergeTimingSummaries: cannot create %s\n", files[0].c_str());
+    return 1;
+  }
+  TDirectory *outDir = out.mkdir(dirName.c_str());
+  summary.write(outDir);
+  if(nSketches > 0) quantiles.write(outDir);
+  out.Write();
+  out.Close();
+  printf("merged %u files, %u run/lumi sections of %u lumis\n", (unsigned int)files.size()-1,
+         (unsigned int)summary.sections().size(), summary.lumisPerSection());
+  if(nSketches > 0) printf("merged %u time quantile sketches\n", nSketches);
+
+  if(trendChannel >= 0){
+    printf("%8s %8s %8s %10s %10s %10s\n", "run", "lumi", "to", "hits", "mean", "err");
+    for(auto const& s : summary.sections()){
+      const TimingMoments& m = s.second[trendChannel];
+      if(m.n == 0) continue;
+      printf("%8u %8u %8u %10.0f %10.3f %10.3f\n", s.first.run, summary.firstLumi(s.first.section), summary.lastLumi(s.first.section),
+             m.n, m.mean(), m.rms()/std::sqrt(m.n));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,154 @@
+// timingSkimToMaps: rebuild the MakeTimingMaps histograms from TimingSkim files
+//
+// usage: timingSkimToMaps [options] output.root skim1.htsk [skim2.htsk ...]
+//   --energy-cut E       rechit energy cut for the maps (default 5)
+//   --time-low T         lower edge of the average time profiles (default -12.5)
+//   --time-high T        upper edge of the average time profiles (default 12.5)
+//   --it lo,hi           in-time window of the energy spectra (default -5,5)
+//   --oot1 lo,hi         first out-of-time window (default 6,12)
+//   --oot2 lo,hi         second out-of-time window (default 12,20)
+//   --window name,lo,hi  another time window of the energy spectra (or a new range for one)
+//   --run N              only use events of run N
+//   --lumis-per-section N  lumi blocks per section of the timing summary (default 10)
+//   --truncate F         fraction cut on each side for the truncated mean maps (default 0.1)
+//   --no-channel-hists   no 200-bin time histogram per channel, only the robust maps
+//
+// The output has the same "timingMaps" directory layout as the TFileService
+// file of MakeTimingMaps, timing summary and per-run maps included, so
+// drawTimingMaps.C and mergeTimingSummaries run on it unchanged.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TDirectory.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingAccumulator.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingSkim.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingSummary.h"
+
+namespace {
+  void usage() {
+    fprintf(stderr, "usage: timingSkimToMaps [--energy-cut E] [--time-low T] [--time-high T]\n"
+                    "                        [--it lo,hi] [--oot1 lo,hi] [--oot2 lo,hi] [--window name,lo,hi] [--run N]\n"
+                    "                        [--lumis-per-section N]\n"
+                    "                        [--truncate F] [--no-channel-hists]\n"
+                    "                        output.root skim.htsk [skim.htsk ...]\n");
+    exit(1);
+  }
+
+  // replace the energy spectra window called name, or add it
+  void setWindow(TimingAccumulator::Config& config, const std::string& name, const char* range) {
+    EnergySpectra::Window window = {name, 0, 0};
+    if(name.empty() || sscanf(range, "%lf,%lf", &window.low, &window.high) != 2) usage();
+    for(EnergySpectra::Window& w : config.spectrumWindows){
+      if(w.name == name){
+        w = window;
+        return;
+      }
+    }
+    config.spectrumWindows.push_back(window);
+  }
+}
+
+int main(int argc, char** argv) {
+  TimingAccumulator::Config config;
+  long run = -1;
+  int lumisPerSection = 10;
+  std::vector<std::string> files;
+
+  for(int i = 1; i < argc; ++i){
+    std::string arg = argv[i];
+    bool hasValue = i+1 < argc;
+    if(arg == "--energy-cut" && hasValue) config.energyCut = atof(argv[++i]);
+    else if(arg == "--time-low" && hasValue) config.timeLow = atof(argv[++i]);
+    else if(arg == "--time-high" && hasValue) config.timeHigh = atof(argv[++i]);
+    else if(arg == "--it" && hasValue) setWindow(config, "IT", argv[++i]);
+    else if(arg == "--oot1" && hasValue) setWindow(config, "OOT1", argv[++i]);
+    else if(arg == "--oot2" && hasValue) setWindow(config, "OOT2", argv[++i]);
+    else if(arg == "--window" && hasValue){
+      const char *spec = argv[++i];
+      const char *comma = strchr(spec, ',');
+      if(!comma) usage();
+      setWindow(config, std::string(spec, comma), comma+1);
+    }
+    else if(arg == "--run" && hasValue) run = atol(argv[++i]);
+    else if(arg == "--lumis-per-section" && hasValue) lumisPerSection = atoi(argv[++i]);
+    else if(arg == "--truncate" && hasValue) config.truncatedFraction = atof(argv[++i]);
+    else if(arg == "--no-channel-hists") config.channelHistograms = false;
+    else if(arg.compare(0, 2, "--") == 0) usage();
+    else files.push_back(arg);
+  }
+  if(files.size() < 2 || lumisPerSection < 1) usage();
+
+  auto start = std::chrono::steady_clock::now();
+  TimingAccumulator timing(config);
+  RecHitBatch hits;
+  unsigned long nEvents = 0, nHits = 0;
+
+  // the moments of the lumi block being read, added to the summary when the
+  // block changes, as endLuminosityBlock of the module does
+  ChannelMoments lumiMoments;
+  TimingSummary summary(lumisPerSection);
+  timing.setLumiMoments(&lumiMoments);
+  bool inLumi = false;
+  uint32_t lumiRun = 0, lumi = 0;
+
+  try {
+    for(unsigned int f = 1; f < files.size(); ++f){
+      TimingSkimReader reader(files[f]);
+      TimingSkimBlock block;
+      while(reader.next(block)){
+        uint32_t hit = 0;
+        for(uint32_t e = 0; e < block.nEvents; ++e){
+          uint32_t end = hit + block.eventHits[e];
+          if(run >= 0 && block.run[e] != run){
+            hit = end;
+            continue;
+          }
+          if(!inLumi || block.run[e] != lumiRun || block.lumi[e] != lumi){
+            if(inLumi) summary.add(lumiRun, lumi, lumiMoments);
+            lumiMoments.clear();
+            inLumi = true;
+            lumiRun = block.run[e];
+            lumi = block.lumi[e];
+          }
+          hits.clear();
+          for(; hit < end; ++hit){
+            int ieta, iphi, depth;
+            decodeHcalDetId(block.rawId[hit], ieta, iphi, depth);
+            hits.push_back(ieta, iphi, depth, block.energy[hit], block.time[hit]);
+          }
+          timing.fill(hits);
+          timing.endEvent();
+          nHits += block.eventHits[e];
+          ++nEvents;
+        }
+      }
+    }
+  } catch(std::exception& e) {
+    fprintf(stderr, "timingSkimToMaps: %s\n", e.what());
+    return 1;
+  }
+  if(inLumi) summary.add(lumiRun, lumi, lumiMoments);
+  double fillTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  TFile out(files[0].c_str(), "RECREATE");
+  if(out.IsZombie()){
+    fprintf(stderr, "timingSkimToMaps: cannot create %s\n", files[0].c_str());
+    return 1;
+  }
+  TDirectory *dir = out.mkdir("timingMaps");
+  timing.write(dir);
+  summary.write(dir);
+  out.Write();
+  out.Close();
+
+  printf("%lu events, %lu rechits from %u files in %.1f s\n", nEvents, nHits, (unsigned int)files.size()-1, fillTime);
+  return 0;
+}
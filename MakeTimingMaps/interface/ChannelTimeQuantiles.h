@@ -0,0 +1,70 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_ChannelTimeQuantiles_h
+#define HBHETimingValidation_MakeTimingMaps_ChannelTimeQuantiles_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      ChannelTimeQuantiles
+//
+/**\class ChannelTimeQuantiles ChannelTimeQuantiles.h HBHETimingValidation/MakeTimingMaps/interface/ChannelTimeQuantiles.h
+
+ Description: robust per-channel time estimates (median, IQR, truncated mean)
+
+ Every channel keeps a 100 bin histogram of its hit times over [-25, 25] ns; write() books
+ hTimeMedian/hTimeIQR/hTimeTruncMean/hTimeUnderflow/hTimeOverflow_Depth* and the sketch
+ hTimeQuantileSketch, which read() adds back. A median is clamped when half the hits are outside.
+*/
+//
+
+#include <vector>
+#include <stdint.h>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/HBHEChannelMap.h"
+
+class TDirectory;
+
+class ChannelTimeQuantiles {
+   public:
+      struct Axis {
+        int nBins;
+        double low;
+        double high;
+
+        Axis() : nBins(100), low(-25), high(25) {}
+      };
+
+      explicit ChannelTimeQuantiles(const Axis& axis = Axis(), double truncatedFraction = 0.1);
+
+      void fill(int channel, double time) {
+        // same bin convention as TH1, 0 is underflow and nBins+1 overflow
+        int bin;
+        if(time < axis_.low) bin = 0;
+        else if(!(time < axis_.high)) bin = axis_.nBins+1;
+        else bin = 1 + int(axis_.nBins*(time-axis_.low)/(axis_.high-axis_.low));
+        ++counts_[channel*(axis_.nBins+2) + bin];
+      }
+
+      const Axis& axis() const { return axis_; }
+      uint32_t entries(int channel) const;
+      // time below which a fraction q of the hits of the channel are, 0 without hits
+      double quantile(int channel, double q) const;
+      double median(int channel) const { return quantile(channel, 0.5); }
+      double iqr(int channel) const { return quantile(channel, 0.75) - quantile(channel, 0.25); }
+      double truncatedMean(int channel) const;
+
+      // add another sketch, throws std::runtime_error if the axes differ; an
+      // empty sketch takes the axis of the other
+      void merge(const ChannelTimeQuantiles& other);
+      // book the maps and the sketch in dir
+      void write(TDirectory* dir) const;
+      // add the hTimeQuantileSketch of dir, false if there is none; an empty
+      // sketch takes the axis of the first one it reads
+      bool read(TDirectory* dir);
+
+   private:
+      Axis axis_;
+      double truncatedFraction_;
+      // (nBins+2) counts per channel, channels one after the other
+      std::vector<uint32_t> counts_;
+};
+
+#endif
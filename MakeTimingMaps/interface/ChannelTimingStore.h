@@ -0,0 +1,76 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_ChannelTimingStore_h
+#define HBHETimingValidation_MakeTimingMaps_ChannelTimingStore_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      ChannelTimingStore
+//
+/**\class ChannelTimingStore ChannelTimingStore.h HBHETimingValidation/MakeTimingMaps/interface/ChannelTimingStore.h
+
+ Description: rechit time histogram of every HBHE channel in one flat array
+
+ Replaces the ~8.9k TH1F which used to be booked per channel. A fill is one
+ index computation and one increment, nothing is registered with ROOT, and
+ TH1F with the old names ("Depth1_ieta-5_iphi12") are only created by write()
+ for the channels which actually got entries.
+*/
+//
+
+#include <vector>
+#include <stdint.h>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/HBHEChannelMap.h"
+
+class TDirectory;
+class TH1;
+
+class ChannelTimingStore {
+   public:
+      // binning of the per-channel histograms, fixed so the channels can share one array
+      static const int nBins = 200;
+      static constexpr double timeMin = -100.0;
+      static constexpr double timeMax = 100.0;
+
+      // one histogram per existing channel, numbered as in HBHEChannelMap
+      static const int nChannels = HBHEChannelMap::nChannels;
+
+      ChannelTimingStore();
+
+      void fill(int channel, double time) {
+        // same bin convention as TH1::Fill, 0 is underflow and nBins+1 overflow
+        int bin;
+        if(time < timeMin) bin = 0;
+        else if(!(time < timeMax)) bin = nBins+1;
+        else {
+          bin = 1 + int(nBins*(time-timeMin)/(timeMax-timeMin));
+          double *s = &stats_[3*channel];
+          s[0] += 1.0;
+          s[1] += time;
+          s[2] += time*time;
+        }
+        ++bins_[channel*(nBins+2) + bin];
+      }
+      void fill(int ieta, int iphi, int depth, double time) {
+        int channel = HBHEChannelMap::channelIndex(ieta, iphi, depth);
+        if(channel >= 0) fill(channel, time);
+      }
+
+      // entries of the channel, including under- and overflow
+      uint32_t entries(int channel) const;
+      const uint32_t* bins(int channel) const { return &bins_[channel*(nBins+2)]; }
+
+      void merge(const ChannelTimingStore& other);
+      // add a histogram written by write() to the channel, throws
+      // std::runtime_error if it has another binning
+      void add(int channel, const TH1& h);
+      // book a TH1F in dir for every channel with entries
+      void write(TDirectory* dir) const;
+
+   private:
+      // (nBins+2) counts per channel, channels one after the other
+      std::vector<uint32_t> bins_;
+      // in-range sum of weights, sum of t and sum of t^2 per channel, as kept by TH1
+      std::vector<double> stats_;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_DepthTimingMaps_h
+#define HBHETimingValidation_MakeTimingMaps_DepthTimingMaps_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      DepthTimingMaps
+//
+/**\class DepthTimingMaps DepthTimingMaps.h HBHETimingValidation/MakeTimingMaps/interface/DepthTimingMaps.h
+
+ Description: average time and occupancy maps of depth 1-3 in plain arrays
+
+ Same content as the hHBHETiming_Depth* TProfile2D and occupancy_d* TH2F, created by write().
+*/
+//
+
+#include <vector>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/HBHEChannelMap.h"
+
+class TDirectory;
+
+class DepthTimingMaps {
+   public:
+      DepthTimingMaps(double timeLow, double timeHigh);
+
+      void fill(int channel, double time) {
+        occupancy_[channel] += 1.0;
+        // TProfile2D skips values outside its range (unless the range is empty)
+        if(hasRange_ && !(time >= timeLow_ && time <= timeHigh_)) return;
+        profN_[channel] += 1.0;
+        profSum_[channel] += time;
+        profSum2_[channel] += time*time;
+      }
+
+      // an empty map takes the time range of the other
+      void merge(const DepthTimingMaps& other);
+      // book hHBHETiming_Depth1-3 and occupancy_d1-3 in dir
+      void write(TDirectory* dir) const;
+      // add the maps in dir, false if they are not all there; empty maps take
+      // the time range of the first profiles they read, otherwise a different
+      // range throws std::runtime_error
+      bool read(TDirectory* dir);
+
+   private:
+      double timeLow_;
+      double timeHigh_;
+      bool hasRange_;
+
+      std::vector<double> occupancy_;
+      std::vector<double> profN_;
+      std::vector<double> profSum_;
+      std::vector<double> profSum2_;
+};
+
+#endif
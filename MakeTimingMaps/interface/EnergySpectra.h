@@ -0,0 +1,98 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_EnergySpectra_h
+#define HBHETimingValidation_MakeTimingMaps_EnergySpectra_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      EnergySpectra
+//
+/**\class EnergySpectra EnergySpectra.h HBHETimingValidation/MakeTimingMaps/interface/EnergySpectra.h
+
+ Description: rechit energy spectra for every (channel group, time window)
+
+ A hit goes into hCheckEnergy<window><group> for every window its time is in and every group
+ its channel is in; the groups are one bit mask per HBHEChannelMap channel.
+*/
+//
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/FixedHistogram.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/HBHEChannelMap.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingCorrelations.h"
+
+class TDirectory;
+
+class EnergySpectra {
+   public:
+      struct Window {
+        std::string name;
+        double low;
+        double high;
+      };
+
+      // channels selects the hits unless allChannels is set; the name is
+      // appended to the histogram names, nBins/low/high is the energy axis
+      struct Group {
+        std::string name;
+        bool allChannels;
+        TimingCorrelations::Group channels;
+        int nBins;
+        double low;
+        double high;
+      };
+
+      static const unsigned int maxGroups = 64;
+      static const unsigned int maxWindows = 32;
+
+      static std::vector<Window> defaultWindows();
+      static std::vector<Group> defaultGroups();
+
+      // throws with more than maxGroups groups or maxWindows windows
+      EnergySpectra(const std::vector<Group>& groups, const std::vector<Window>& windows);
+
+      // bit w set if time is in window w
+      uint32_t windowMask(double time) const {
+        uint32_t mask = 0;
+        for(unsigned int w = 0; w < windows_.size(); ++w) mask |= uint32_t((time > windows_[w].low) & (time < windows_[w].high)) << w;
+        return mask;
+      }
+      // same for n hits at once, window by window so the compares vectorize
+      void windowMasks(unsigned int n, const float* time, uint32_t* masks) const;
+
+      // channel -1 for hits of channels which do not exist
+      void fill(int channel, double energy, uint32_t windows) {
+        if(!windows) return;
+        uint64_t groups = allChannelGroups_ | (channel >= 0 ? selectedGroups_[channel] : 0);
+        while(groups){
+          FixedHistogram *h = &spectra_[__builtin_ctzll(groups)*windows_.size()];
+          groups &= groups-1;
+          for(uint32_t w = windows; w; w &= w-1) h[__builtin_ctz(w)].fill(energy);
+        }
+      }
+      void fill(int channel, double energy, double time) { fill(channel, energy, windowMask(time)); }
+      // n hits, masks from windowMasks(); every spectrum sees its hits in the
+      // same order as with the single-hit fill
+      void fill(unsigned int n, const int* channel, const float* energy, const uint32_t* masks);
+
+      const std::vector<Window>& windows() const { return windows_; }
+
+      // add the spectra of another EnergySpectra with the same groups and windows
+      void merge(const EnergySpectra& other);
+      // hCheckEnergy<window><group> in dir
+      void write(TDirectory* dir) const;
+
+   private:
+      std::vector<Group> groups_;
+      std::vector<Window> windows_;
+      // groups of all channels, and the other groups of every HBHEChannelMap channel
+      uint64_t allChannelGroups_;
+      std::vector<uint64_t> selectedGroups_;
+      // group g, window w at g*windows_.size() + w
+      std::vector<FixedHistogram> spectra_;
+      // hits in the window being filled, kept to avoid reallocating every event
+      std::vector<uint32_t> index_;
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_FixedHistogram_h
+#define HBHETimingValidation_MakeTimingMaps_FixedHistogram_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      FixedHistogram, FixedHistogram2D
+//
+/**\class FixedHistogram FixedHistogram.h HBHETimingValidation/MakeTimingMaps/interface/FixedHistogram.h
+
+ Description: fixed-binning histograms in plain arrays for the fill paths
+
+ Same bin numbering (0 underflow, nBins+1 overflow), entries and statistics
+ sums as TH1F/TH2F, but the fill is inline and there is no ROOT object until
+ makeTH1F()/makeTH2F() at the end of the job, so the result is
+ indistinguishable from filling the ROOT histogram directly.
+*/
+//
+
+#include <vector>
+
+class TH1F;
+class TH2F;
+
+class FixedHistogram {
+   public:
+      FixedHistogram(int nBins, double xMin, double xMax);
+
+      int findBin(double x) const {
+        if(x < xMin_) return 0;
+        if(!(x < xMax_)) return nBins_+1;
+        return 1 + int(nBins_*(x-xMin_)/(xMax_-xMin_));
+      }
+
+      void fill(double x, double w = 1.0) {
+        int bin = findBin(x);
+        counts_[bin] += w;
+        entries_ += 1.0;
+        if(bin > 0 && bin <= nBins_){
+          sumw_ += w;
+          sumw2_ += w*w;
+          sumwx_ += w*x;
+          sumwx2_ += w*x*x;
+        }
+      }
+
+      int nBins() const { return nBins_; }
+      double xMin() const { return xMin_; }
+      double xMax() const { return xMax_; }
+      double binContent(int bin) const { return counts_[bin]; }
+      double entries() const { return entries_; }
+
+      void merge(const FixedHistogram& other);
+      // a TH1F with the same content, attached to the current directory; like every
+      // histogram of the package it is then owned by the directory and written with the file
+      TH1F* makeTH1F(const char* name, const char* title) const;
+
+   private:
+      int nBins_;
+      double xMin_;
+      double xMax_;
+      std::vector<double> counts_;
+      double entries_;
+      double sumw_;
+      double sumw2_;
+      double sumwx_;
+      double sumwx2_;
+};
+
+class FixedHistogram2D {
+   public:
+      FixedHistogram2D(int nBinsX, double xMin, double xMax, int nBinsY, double yMin, double yMax);
+
+      void fill(double x, double y, double w = 1.0) {
+        int bx = x_.findBin(x);
+        int by = y_.findBin(y);
+        counts_[by*(x_.nBins()+2) + bx] += w;
+        entries_ += 1.0;
+        if(bx > 0 && bx <= x_.nBins() && by > 0 && by <= y_.nBins()){
+          sumw_ += w;
+          sumw2_ += w*w;
+          sumwx_ += w*x;
+          sumwx2_ += w*x*x;
+          sumwy_ += w*y;
+          sumwy2_ += w*y*y;
+          sumwxy_ += w*x*y;
+        }
+      }
+
+      void merge(const FixedHistogram2D& other);
+      // same for a TH2F
+      TH2F* makeTH2F(const char* name, const char* title) const;
+
+   private:
+      // only used for the binning
+      FixedHistogram x_;
+      FixedHistogram y_;
+      std::vector<double> counts_;
+      double entries_;
+      double sumw_;
+      double sumw2_;
+      double sumwx_;
+      double sumwx2_;
+      double sumwy_;
+      double sumwy2_;
+      double sumwxy_;
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_HBHEChannelMap_h
+#define HBHETimingValidation_MakeTimingMaps_HBHEChannelMap_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      HBHEChannelMap
+//
+/**\class HBHEChannelMap HBHEChannelMap.h HBHETimingValidation/MakeTimingMaps/interface/HBHEChannelMap.h
+
+ Description: the HBHE channels (depth 1-3) in one dense numbering, built at compile time
+
+ Only the 5184 channels which exist get an index (above |ieta| 20 only odd iphi):
+   depth 1   1-29
+   depth 2   15-16 (HB), 18-29 (HE)
+   depth 3   16, 27-28 (HE)
+*/
+//
+
+class HBHEChannelMap {
+   public:
+      struct Channel {
+        signed char ieta;
+        unsigned char iphi;
+        unsigned char depth;
+        // 0 HB, 1 HE
+        unsigned char subdet;
+        // 0 for iphi 3-26, 1 for 27-50, 2 for 51-72 and 1-2
+        unsigned char phiPartition;
+      };
+
+      static constexpr bool exists(int ieta, int iphi, int depth) {
+        const int aeta = ieta < 0 ? -ieta : ieta;
+        if(aeta < 1 || aeta > 29 || iphi < 1 || iphi > 72) return false;
+        if(aeta > 20 && iphi%2 == 0) return false;
+        if(depth == 1) return true;
+        if(depth == 2) return aeta == 15 || aeta == 16 || aeta >= 18;
+        if(depth == 3) return aeta == 16 || aeta == 27 || aeta == 28;
+        return false;
+      }
+
+      static constexpr bool isHE(int ieta, int depth) {
+        const int aeta = ieta < 0 ? -ieta : ieta;
+        return aeta > 16 || (aeta == 16 && depth == 3);
+      }
+
+      static constexpr int phiPartition(int iphi) {
+        return (iphi >= 3 && iphi <= 26) ? 0 : (iphi >= 27 && iphi <= 50) ? 1 : 2;
+      }
+
+      // depth x ieta x iphi grid the numbering is made from
+      static const int nEta = 59;
+      static const int nPhi = 72;
+      static const int nCells = 3*nEta*nPhi;
+
+      static constexpr int countChannels() {
+        int n = 0;
+        for(int cell = 0; cell < nCells; ++cell) if(exists(cellEta(cell), cellPhi(cell), cellDepth(cell))) ++n;
+        return n;
+      }
+
+      static const int nChannels = 5184;
+
+      // dense index of the channel, -1 if it does not exist
+      static int channelIndex(int ieta, int iphi, int depth) {
+        if(depth < 1 || depth > 3 || ieta < -29 || ieta > 29 || iphi < 1 || iphi > 72) return -1;
+        return table().cellToChannel[((depth-1)*nEta + ieta+29)*nPhi + iphi-1];
+      }
+
+      static const Channel& channel(int index) { return table().channels[index]; }
+
+      static void channelCoordinates(int index, int& ieta, int& iphi, int& depth) {
+        const Channel& c = channel(index);
+        ieta = c.ieta;
+        iphi = c.iphi;
+        depth = c.depth;
+      }
+
+   private:
+      struct Table {
+        Channel channels[nChannels];
+        short cellToChannel[nCells];
+      };
+
+      static constexpr int cellDepth(int cell) { return 1 + cell/(nEta*nPhi); }
+      static constexpr int cellEta(int cell) { return (cell/nPhi)%nEta - 29; }
+      static constexpr int cellPhi(int cell) { return cell%nPhi + 1; }
+
+      // channels ordered by depth, then ieta, then iphi
+      static constexpr Table makeTable() {
+        Table t{};
+        int n = 0;
+        for(int cell = 0; cell < nCells; ++cell){
+          const int ieta = cellEta(cell), iphi = cellPhi(cell), depth = cellDepth(cell);
+          if(!exists(ieta, iphi, depth)){
+            t.cellToChannel[cell] = -1;
+            continue;
+          }
+          Channel& c = t.channels[n];
+          c.ieta = ieta;
+          c.iphi = iphi;
+          c.depth = depth;
+          c.subdet = isHE(ieta, depth) ? 1 : 0;
+          c.phiPartition = phiPartition(iphi);
+          t.cellToChannel[cell] = n++;
+        }
+        return t;
+      }
+
+      static const Table& table() {
+        static constexpr Table t = makeTable();
+        return t;
+      }
+};
+
+static_assert(HBHEChannelMap::countChannels() == HBHEChannelMap::nChannels, "HBHEChannelMap: wrong channel count");
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_MergedTimingMaps_h
+#define HBHETimingValidation_MakeTimingMaps_MergedTimingMaps_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      MergedTimingMaps
+//
+/**\class MergedTimingMaps MergedTimingMaps.h HBHETimingValidation/MakeTimingMaps/interface/MergedTimingMaps.h
+
+ Description: the histograms of many MakeTimingMaps outputs added up
+
+ add() reads one output directory into plain arrays (nothing stays attached to the input),
+ merge() adds two of them, write() books the same objects as the module. Pulse shapes are not merged.
+*/
+//
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/ChannelTimeQuantiles.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/ChannelTimingStore.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/DepthTimingMaps.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingSummary.h"
+
+class TDirectory;
+class TH1;
+
+class MergedTimingMaps {
+   public:
+      MergedTimingMaps();
+      ~MergedTimingMaps();
+
+      // add the output in dir, false (and nothing added) if it has no time
+      // maps; throws std::runtime_error if it cannot be added to what is there
+      bool add(TDirectory* dir);
+      // add another MergedTimingMaps, same exceptions as add()
+      void merge(const MergedTimingMaps& other);
+      // book everything in dir
+      void write(TDirectory* dir) const;
+
+      unsigned int inputs() const { return inputs_; }
+
+   private:
+      // add h to the histogram of the same name, a copy of h if there is none
+      void addHistogram(const TH1& h);
+
+      unsigned int inputs_;
+      DepthTimingMaps maps_;
+      // only once an input has per-channel histograms (not with channelHistograms = False)
+      std::unique_ptr<ChannelTimingStore> channelTimes_;
+      ChannelTimeQuantiles quantiles_;
+      unsigned int sketches_;
+      TimingSummary summary_;
+      std::map<std::string, std::unique_ptr<TH1> > histograms_;
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_PulseShapeCapture_h
+#define HBHETimingValidation_MakeTimingMaps_PulseShapeCapture_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      PulseShapeCapture
+//
+/**\class PulseShapeCapture PulseShapeCapture.h HBHETimingValidation/MakeTimingMaps/interface/PulseShapeCapture.h
+
+ Description: ADC pulse shapes of selected rechits, from the auxiliary words
+
+ Hits above energyCut which are out of [timeLow, timeHigh] or in a channel group are captured:
+ average shapes "PulseShape_Depth1_ieta-5_iphi12" in pulseShapes/ and the last maxCaptures
+ hits in the TTree "pulseCaptures".
+*/
+//
+
+#include <vector>
+#include <stdint.h>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/HBHEChannelMap.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingCorrelations.h"
+
+class TDirectory;
+
+class PulseShapeCapture {
+   public:
+      static const int nSamples = 8;
+
+      struct Config {
+        // hits at or below this energy are never captured
+        double energyCut;
+        // hits outside [timeLow, timeHigh] are captured, no time trigger if timeLow >= timeHigh
+        double timeLow;
+        double timeHigh;
+        // hits in these channels are captured whatever their time
+        std::vector<TimingCorrelations::Group> channels;
+        // raw samples are kept of this many hits, the latest ones
+        unsigned int maxCaptures;
+
+        Config() : energyCut(20.0), timeLow(-12.5), timeHigh(12.5), maxCaptures(1000) {}
+      };
+
+      struct Capture {
+        uint32_t run;
+        uint32_t lumi;
+        uint64_t event;
+        int channel;
+        float energy;
+        float time;
+        uint8_t adc[nSamples];
+      };
+
+      // the 7-bit samples of TS 0-3 are in the low 28 bits of auxHBHE, TS 4-7 in aux;
+      // put both in one word and take the samples out with fixed shifts
+      static void unpack(uint32_t auxHBHE, uint32_t aux, uint8_t adc[nSamples]) {
+        const uint64_t words = (uint64_t(auxHBHE) & 0xFFFFFFF) | ((uint64_t(aux) & 0xFFFFFFF) << 28);
+        for(int i = 0; i < nSamples; ++i) adc[i] = (words >> 7*i) & 0x7F;
+      }
+
+      explicit PulseShapeCapture(const Config& config);
+
+      void beginEvent(uint32_t run, uint32_t lumi, uint64_t event) {
+        run_ = run;
+        lumi_ = lumi;
+        event_ = event;
+      }
+
+      void fill(int ieta, int iphi, int depth, double energy, double time, uint32_t auxHBHE, uint32_t aux) {
+        // most hits stop here
+        if(!(energy > config_.energyCut)) return;
+        const bool outOfTime = timeTrigger_ && (time < config_.timeLow || time > config_.timeHigh);
+        if(!outOfTime && !anyChannels_) return;
+        const int channel = HBHEChannelMap::channelIndex(ieta, iphi, depth);
+        if(channel < 0 || !(outOfTime || selected_[channel])) return;
+        capture(channel, energy, time, auxHBHE, aux);
+      }
+
+      // hits captured so far, also those no longer in the ring buffer
+      uint64_t nCaptured() const { return nCaptured_; }
+      // the ring buffer, oldest first
+      std::vector<Capture> captures() const;
+
+      // add the shapes of other; of both ring buffers the last maxCaptures
+      // hits in (run, lumi, event) order are kept
+      void merge(const PulseShapeCapture& other);
+      void write(TDirectory* dir) const;
+
+   private:
+      void capture(int channel, double energy, double time, uint32_t auxHBHE, uint32_t aux);
+
+      Config config_;
+      bool timeTrigger_;
+      bool anyChannels_;
+      // 1 for the channels of config_.channels, numbered as in HBHEChannelMap
+      std::vector<uint8_t> selected_;
+
+      // per channel nSamples sums of the ADC counts and of their squares
+      std::vector<double> sum_;
+      std::vector<double> sum2_;
+      std::vector<uint32_t> count_;
+
+      // once the ring is full the next capture replaces ring_[next_], the oldest one
+      std::vector<Capture> ring_;
+      unsigned int next_;
+      uint64_t nCaptured_;
+
+      uint32_t run_;
+      uint32_t lumi_;
+      uint64_t event_;
+};
+
+#endif
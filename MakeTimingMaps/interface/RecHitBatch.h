@@ -0,0 +1,62 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_RecHitBatch_h
+#define HBHETimingValidation_MakeTimingMaps_RecHitBatch_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      RecHitBatch
+//
+/**\class RecHitBatch RecHitBatch.h HBHETimingValidation/MakeTimingMaps/interface/RecHitBatch.h
+
+ Description: the rechits of one event as structure-of-arrays
+
+ Kept between events, so the buffers only grow until they fit the busiest event.
+*/
+//
+
+#include <vector>
+
+class RecHitBatch {
+   public:
+      RecHitBatch() : size_(0) {}
+
+      void clear() { size_ = 0; }
+
+      void reserve(unsigned int n) {
+        if(n <= ieta_.size()) return;
+        ieta_.resize(n);
+        iphi_.resize(n);
+        depth_.resize(n);
+        energy_.resize(n);
+        time_.resize(n);
+      }
+
+      void push_back(int ieta, int iphi, int depth, float energy, float time) {
+        // one capacity check for all the columns
+        if(size_ == ieta_.size()) reserve(2*size_ + 256);
+        ieta_[size_] = ieta;
+        iphi_[size_] = iphi;
+        depth_[size_] = depth;
+        energy_[size_] = energy;
+        time_[size_] = time;
+        ++size_;
+      }
+
+      unsigned int size() const { return size_; }
+
+      const int* ieta() const { return ieta_.data(); }
+      const int* iphi() const { return iphi_.data(); }
+      const int* depth() const { return depth_.data(); }
+      const float* energy() const { return energy_.data(); }
+      const float* time() const { return time_.data(); }
+
+   private:
+      unsigned int size_;
+      // the columns are sized to the capacity, only the first size_ entries are used
+      std::vector<int> ieta_;
+      std::vector<int> iphi_;
+      std::vector<int> depth_;
+      std::vector<float> energy_;
+      std::vector<float> time_;
+};
+
+#endif
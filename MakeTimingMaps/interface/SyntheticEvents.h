@@ -0,0 +1,62 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_SyntheticEvents_h
+#define HBHETimingValidation_MakeTimingMaps_SyntheticEvents_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      SyntheticEventGenerator
+//
+/**\class SyntheticEventGenerator SyntheticEvents.h HBHETimingValidation/MakeTimingMaps/interface/SyntheticEvents.h
+
+ Description: HBHE rechit events for benchmarks, without any input files
+
+ One hit per channel with probability occupancy, signal- or noise-like energy, a per-channel
+ time offset plus resolution or flat out-of-time pileup. The same seed gives the same events.
+*/
+//
+
+#include <random>
+#include <vector>
+#include <stdint.h>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/HBHEChannelMap.h"
+
+// what the modules read from an HBHERecHit
+struct SyntheticHit {
+  int ieta, iphi, depth;
+  float energy, time;
+  uint32_t auxHBHE, aux;
+};
+
+class SyntheticEventGenerator {
+   public:
+      struct Config {
+        double occupancy;
+        double signalFraction;
+        double noiseEnergy;
+        double signalEnergy;
+        double offsetSpread;
+        double timeResolution;
+        double ootFraction;
+        double ootLow;
+        double ootHigh;
+        unsigned int seed;
+
+        Config() : occupancy(0.5), signalFraction(0.1), noiseEnergy(2.0), signalEnergy(40.0),
+                   offsetSpread(1.5), timeResolution(3.0), ootFraction(0.2), ootLow(-50.0), ootHigh(75.0),
+                   seed(1) {}
+      };
+
+      explicit SyntheticEventGenerator(const Config& config);
+
+      // replace hits by the next event
+      void next(std::vector<SyntheticHit>& hits);
+
+      double channelOffset(int channel) const { return offsets_[channel]; }
+
+   private:
+      Config config_;
+      std::mt19937 rng_;
+      std::vector<float> offsets_;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_TimingAccumulator_h
+#define HBHETimingValidation_MakeTimingMaps_TimingAccumulator_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      TimingAccumulator
+//
+/**\class TimingAccumulator TimingAccumulator.h HBHETimingValidation/MakeTimingMaps/interface/TimingAccumulator.h
+
+ Description: one complete set of the HBHE timing histograms (maps, occupancy,
+              per-channel times, robust time maps, energy spectra per channel
+              group and time window, and the same-event correlations).
+
+ Filled in plain arrays, one copy per stream, added up and written as ROOT histograms by write().
+*/
+//
+
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/ChannelTimeQuantiles.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/ChannelTimingStore.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/DepthTimingMaps.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/EnergySpectra.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/RecHitBatch.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingCorrelations.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingSummary.h"
+
+class TDirectory;
+struct TimingHitCounters;
+
+class TimingAccumulator {
+   public:
+      struct Config {
+        // rechit energy above which the time goes into the maps
+        double energyCut;
+        // time range of the average time profiles
+        double timeLow;
+        double timeHigh;
+        // energy spectra of every channel group in every time window
+        std::vector<EnergySpectra::Group> spectrumGroups;
+        std::vector<EnergySpectra::Window> spectrumWindows;
+        // same-event correlations between groups of channels
+        TimingCorrelations::Axis correlationAxis;
+        std::vector<TimingCorrelations::Pair> correlations;
+        // median, IQR and truncated mean per channel
+        ChannelTimeQuantiles::Axis quantileAxis;
+        double truncatedFraction;
+        // the 200-bin time histogram of every channel, can be dropped in production
+        bool channelHistograms;
+
+        Config(double cut = 5.0, double low = -12.5, double high = 12.5) :
+          energyCut(cut), timeLow(low), timeHigh(high),
+          spectrumGroups(EnergySpectra::defaultGroups()),
+          spectrumWindows(EnergySpectra::defaultWindows()),
+          correlations(TimingCorrelations::defaultPairs()),
+          truncatedFraction(0.1), channelHistograms(true) {}
+      };
+
+      explicit TimingAccumulator(const Config& config);
+
+      // fill everything which depends on a single rechit
+      void fill(int ieta, int iphi, int depth, double energy, double time);
+      // same for all the rechits of an event at once
+      void fill(const RecHitBatch& hits);
+      // fill the same-event correlations from the hits given to fill()
+      void endEvent();
+
+      // hits passing the energy cut also go into these moments (e.g. those of the
+      // current lumi block), nullptr to stop
+      void setLumiMoments(ChannelMoments* moments) { lumiMoments_ = moments; }
+      // count the hits filled, by energy cut, depth and time window; nullptr to stop
+      void setCounters(TimingHitCounters* counters);
+
+      // add the contents of another accumulator booked with the same settings
+      void merge(const TimingAccumulator& other);
+      // create all the histograms in dir
+      void write(TDirectory* dir) const;
+
+   private:
+      // channel from HBHEChannelMap, -1 for channels which do not exist
+      void fillTiming(int channel, double time);
+      void countWindows(uint32_t windows);
+
+      Config config_;
+
+      // average time per channel and occupancy, 1 map for each depth
+      DepthTimingMaps maps_;
+
+      // individual rechit timing histograms for each channel, unless switched off
+      std::unique_ptr<ChannelTimingStore> channelTimes_;
+      // robust time estimates for each channel
+      ChannelTimeQuantiles quantiles_;
+      ChannelMoments *lumiMoments_;
+      TimingHitCounters *counters_;
+
+      // Check for correlation between same iphi or adjacent iphi
+      TimingCorrelations correlations_;
+
+      // Get energy distributions of channel groups
+      EnergySpectra spectra_;
+
+      // channel, time windows and the hits passing the energy cut of the batch
+      // being filled, kept to avoid reallocating every event
+      std::vector<int> channel_;
+      std::vector<uint32_t> windows_;
+      std::vector<uint32_t> passing_;
+};
+
+#endif
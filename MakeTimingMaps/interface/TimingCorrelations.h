@@ -0,0 +1,119 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_TimingCorrelations_h
+#define HBHETimingValidation_MakeTimingMaps_TimingCorrelations_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      TimingCorrelations
+//
+/**\class TimingCorrelations TimingCorrelations.h HBHETimingValidation/MakeTimingMaps/interface/TimingCorrelations.h
+
+ Description: same-event time correlations between configurable groups of channels
+
+ For every pair of groups (A, B): hCorrTiming<name> (t_A vs t_B) and hCheckTiming<name> (t_A - t_B),
+ made from per-event time histograms of the groups, so the differences are multiples of the bin width.
+*/
+//
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/HBHEChannelMap.h"
+
+class TDirectory;
+
+class TimingCorrelations {
+   public:
+      // channels with depth in depths, ieta in [ietaLow, ietaHigh] and iphi in iphis
+      struct Group {
+        std::vector<int> depths;
+        int ietaLow;
+        int ietaHigh;
+        std::vector<int> iphis;
+
+        bool contains(int ieta, int iphi, int depth) const;
+        bool operator==(const Group& other) const {
+          return depths == other.depths && ietaLow == other.ietaLow && ietaHigh == other.ietaHigh && iphis == other.iphis;
+        }
+      };
+
+      struct Pair {
+        std::string name;
+        Group a;
+        Group b;
+      };
+
+      // time axis of the correlation histograms, the time differences go up to
+      // maxShift bin widths either way
+      struct Axis {
+        int nBins;
+        double low;
+        double high;
+        int maxShift;
+
+        Axis() : nBins(100), low(-25), high(75), maxShift(25) {}
+      };
+
+      // depth 1, ieta 1-16: iphi 67 with itself and iphi 67 vs 66, the pairs
+      // MakeTimingMaps has always looked at
+      static std::vector<Pair> defaultPairs();
+
+      TimingCorrelations(const Axis& axis, const std::vector<Pair>& pairs);
+
+      void fill(int channel, double time) {
+        const int begin = channelGroupBegin_[channel], end = channelGroupBegin_[channel+1];
+        if(begin == end) return;
+        // same bin convention as TH1, 0 is underflow and nBins+1 overflow
+        int bin;
+        if(time < axis_.low) bin = 0;
+        else if(!(time < axis_.high)) bin = axis_.nBins+1;
+        else bin = 1 + int(axis_.nBins*(time-axis_.low)/(axis_.high-axis_.low));
+        for(int i = begin; i < end; ++i){
+          EventGroup& g = groups_[channelGroups_[i]];
+          if(g.counts[bin]++ == 0) g.touched[g.nTouched++] = bin;
+          ++g.nHits;
+        }
+      }
+
+      // add the hit pairs of the event to the histograms and reset the groups
+      void endEvent();
+
+      void merge(const TimingCorrelations& other);
+      void write(TDirectory* dir) const;
+
+   private:
+      // hit times of one group in the current event
+      struct EventGroup {
+        Group group;
+        // hits per time bin, including under- and overflow
+        std::vector<uint32_t> counts;
+        // bins with hits, there can never be more than all of them
+        std::vector<uint32_t> touched;
+        unsigned int nTouched;
+        uint32_t nHits;
+      };
+
+      struct PairHistograms {
+        std::string name;
+        int a;
+        int b;
+        // (nBins+2)^2 correlation bins, the A time is the x axis
+        std::vector<double> corr;
+        // 2*maxShift+1 time differences plus under- and overflow
+        std::vector<double> diff;
+        double corrEntries;
+        double diffEntries;
+      };
+
+      void addCross(const EventGroup& a, const EventGroup& b, double weight, PairHistograms& h) const;
+
+      Axis axis_;
+      std::vector<EventGroup> groups_;
+      std::vector<PairHistograms> pairs_;
+
+      // groups of every HBHEChannelMap channel: channelGroups_[channelGroupBegin_[ch] ... channelGroupBegin_[ch+1]-1]
+      std::vector<int> channelGroupBegin_;
+      std::vector<int> channelGroups_;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_TimingInstrumentation_h
+#define HBHETimingValidation_MakeTimingMaps_TimingInstrumentation_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      TimingInstrumentation
+//
+/**\class TimingInstrumentation TimingInstrumentation.h HBHETimingValidation/MakeTimingMaps/interface/TimingInstrumentation.h
+
+ Description: where the time of a MakeTimingMaps job goes
+
+ Wall time and calls per stage, the time per event and the hit counters, merged over the streams
+ and written by writeSummary() as JSON. Only made when instrumentationFile is set.
+*/
+//
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// hits seen by TimingAccumulator::fill, see TimingAccumulator::setCounters
+struct TimingHitCounters {
+  uint64_t hits = 0;
+  // above the rechitEnergy cut, all of them and by depth 1-3
+  uint64_t passing = 0;
+  uint64_t passingDepth[3] = {0, 0, 0};
+  // in each time window of the energy spectra (IT, OOT1, OOT2 by default)
+  std::vector<std::string> windowNames;
+  std::vector<uint64_t> windowHits;
+
+  void merge(const TimingHitCounters& other);
+};
+
+class TimingInstrumentation {
+   public:
+      enum Stage { kGetRecHits, kHitLoop, kFill, kCorrelations, kWrite, nStages };
+      // the per-event histogram has bins [2^(k-1), 2^k) us, the first one
+      // everything below 1 us and the last one everything above
+      static const int nLatencyBins = 26;
+
+      typedef std::chrono::steady_clock Clock;
+
+      TimingInstrumentation();
+
+      void addStage(Stage stage, Clock::duration elapsed) {
+        stageNs_[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        ++stageCalls_[stage];
+      }
+      void addEvent(Clock::duration elapsed);
+
+      TimingHitCounters& counters() { return counters_; }
+
+      void merge(const TimingInstrumentation& other);
+      // JSON with the module label, the number of streams merged and the wall
+      // time of the job; throws if the file cannot be written
+      void writeSummary(const std::string& fileName, const std::string& module,
+                        unsigned int streams, double jobSeconds) const;
+
+      static const char* stageName(Stage stage);
+
+   private:
+      uint64_t stageNs_[nStages];
+      uint64_t stageCalls_[nStages];
+      uint64_t events_;
+      uint64_t eventNs_;
+      uint64_t maxEventNs_;
+      uint64_t latency_[nLatencyBins];
+      TimingHitCounters counters_;
+};
+
+// adds the time from construction to destruction (or stop()) to a stage,
+// nothing at all without a TimingInstrumentation
+class StageTimer {
+   public:
+      StageTimer(TimingInstrumentation* instrumentation, TimingInstrumentation::Stage stage) :
+        instrumentation_(instrumentation), stage_(stage)
+      {
+        if(instrumentation_) start_ = TimingInstrumentation::Clock::now();
+      }
+      ~StageTimer() { stop(); }
+
+      // add the time up to now, and nothing more later
+      void stop() {
+        if(!instrumentation_) return;
+        instrumentation_->addStage(stage_, TimingInstrumentation::Clock::now() - start_);
+        instrumentation_ = nullptr;
+      }
+
+   private:
+      TimingInstrumentation *instrumentation_;
+      TimingInstrumentation::Stage stage_;
+      TimingInstrumentation::Clock::time_point start_;
+};
+
+#endif
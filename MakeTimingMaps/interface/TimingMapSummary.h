@@ -0,0 +1,77 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_TimingMapSummary_h
+#define HBHETimingValidation_MakeTimingMaps_TimingMapSummary_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      TimingMapSummary
+//
+/**\class TimingMapSummary TimingMapSummary.h HBHETimingValidation/MakeTimingMaps/interface/TimingMapSummary.h
+
+ Description: the per-channel summaries drawTimingMaps.C makes from an output
+
+ read() takes what the plots need in one pass, fill() makes the macro's summary histograms and
+ writeTable() stores the channel statistics as the channelSummary tree.
+*/
+//
+
+#include <memory>
+#include <vector>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/HBHEChannelMap.h"
+
+class TDirectory;
+class TH1;
+class TH1D;
+class TH1F;
+class TH2;
+class TH2D;
+class TProfile2D;
+
+class TimingMapSummary {
+   public:
+      struct ChannelStats {
+        double time;
+        double rms;
+        double events;
+      };
+
+      // everything read from one output
+      struct Input {
+        TProfile2D *timing[3] = {nullptr, nullptr, nullptr};
+        TH2 *occupancy[3] = {nullptr, nullptr, nullptr};
+        // only in outputs with the robust time maps
+        TH2 *median[3] = {nullptr, nullptr, nullptr};
+        TH2 *iqr[3] = {nullptr, nullptr, nullptr};
+        TH2 *truncMean[3] = {nullptr, nullptr, nullptr};
+        TH2 *corr66to67 = nullptr;
+        TH2 *corrPhi67Plus = nullptr;
+        // per-channel time histograms of the channels read, by HBHEChannelMap channel
+        std::vector<TH1*> channels = std::vector<TH1*>(HBHEChannelMap::nChannels, nullptr);
+        // by HBHEChannelMap channel from the channelSummary tree, empty without one
+        std::vector<ChannelStats> table;
+      };
+
+      // false if the maps are not all there; per-channel histograms are only
+      // read where readChannel(ieta, iphi) is true, none without it
+      static bool read(TDirectory* dir, Input& in, bool (*readChannel)(int ieta, int iphi) = nullptr);
+
+      TimingMapSummary();
+      ~TimingMapSummary();
+
+      // the channel statistics, then the summary histograms; once per TimingMapSummary
+      void fill(const Input& in);
+      const std::vector<ChannelStats>& stats() const { return stats_; }
+      // the channelSummary tree in dir
+      void writeTable(TDirectory* dir) const;
+
+      // by depth
+      std::unique_ptr<TH2D> rms[3], err[3];
+      // by iphi partition
+      std::unique_ptr<TH1D> rmsHist[3], timeHist[3], timeHistHB[3], timeHistHE[3];
+      std::unique_ptr<TH1F> timeAll;
+
+   private:
+      std::vector<ChannelStats> stats_;
+};
+
+#endif
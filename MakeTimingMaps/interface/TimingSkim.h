@@ -0,0 +1,110 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_TimingSkim_h
+#define HBHETimingValidation_MakeTimingMaps_TimingSkim_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      TimingSkimWriter, TimingSkimReader
+//
+/**\class TimingSkimWriter TimingSkim.h HBHETimingValidation/MakeTimingMaps/interface/TimingSkim.h
+
+ Description: compact columnar file with the rechit information the timing maps need
+
+ A 16 byte header (with the byte order of the writer) followed by 8 byte aligned blocks:
+
+   block header   uint32 nEvents, uint32 nHits
+   event columns  uint32 run[nEvents], uint32 lumi[nEvents], uint64 event[nEvents],
+                  uint32 nHitsInEvent[nEvents]
+   hit columns    uint32 rawId[nHits], float energy[nHits], float eraw[nHits],
+                  float time[nHits], uint32 auxHBHE[nHits], uint32 aux[nHits]
+*/
+//
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// one block of a skim file, the pointers are only valid while the reader is alive
+struct TimingSkimBlock {
+  uint32_t nEvents;
+  uint32_t nHits;
+
+  const uint32_t *run;
+  const uint32_t *lumi;
+  const uint64_t *event;
+  const uint32_t *eventHits;
+
+  const uint32_t *rawId;
+  const float *energy;
+  const float *eraw;
+  const float *time;
+  const uint32_t *auxHBHE;
+  const uint32_t *aux;
+};
+
+class TimingSkimWriter {
+   public:
+      // hits are buffered and written out in blocks of about blockHits
+      explicit TimingSkimWriter(const std::string& fileName, unsigned int blockHits = 1<<16);
+      ~TimingSkimWriter();
+
+      void beginEvent(uint32_t run, uint32_t lumi, uint64_t event);
+      void addHit(uint32_t rawId, float energy, float eraw, float time, uint32_t auxHBHE, uint32_t aux) {
+        rawId_.push_back(rawId);
+        energy_.push_back(energy);
+        eraw_.push_back(eraw);
+        time_.push_back(time);
+        auxHBHE_.push_back(auxHBHE);
+        aux_.push_back(aux);
+        ++eventHits_.back();
+      }
+      void endEvent();
+
+      // write whatever is buffered as one block
+      void flush();
+
+   private:
+      void writeColumn(const void* data, size_t bytes);
+
+      FILE *file_;
+      std::string fileName_;
+      unsigned int blockHits_;
+
+      std::vector<uint32_t> run_;
+      std::vector<uint32_t> lumi_;
+      std::vector<uint64_t> event_;
+      std::vector<uint32_t> eventHits_;
+
+      std::vector<uint32_t> rawId_;
+      std::vector<float> energy_;
+      std::vector<float> eraw_;
+      std::vector<float> time_;
+      std::vector<uint32_t> auxHBHE_;
+      std::vector<uint32_t> aux_;
+};
+
+class TimingSkimReader {
+   public:
+      // maps the whole file read-only, throws std::runtime_error if that fails
+      explicit TimingSkimReader(const std::string& fileName);
+      ~TimingSkimReader();
+
+      // point block at the next block of the file, false once the file is done;
+      // throws std::runtime_error if the block does not fit in the file or its
+      // hits per event do not add up to nHits
+      bool next(TimingSkimBlock& block);
+
+   private:
+      TimingSkimReader(const TimingSkimReader&) = delete;
+      TimingSkimReader& operator=(const TimingSkimReader&) = delete;
+
+      std::string fileName_;
+      const char *data_;
+      size_t size_;
+      size_t pos_;
+};
+
+// ieta, iphi and depth from a raw HcalDetId, old and new packing
+void decodeHcalDetId(uint32_t rawId, int& ieta, int& iphi, int& depth);
+
+#endif
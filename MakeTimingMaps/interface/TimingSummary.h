@@ -0,0 +1,97 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_TimingSummary_h
+#define HBHETimingValidation_MakeTimingMaps_TimingSummary_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      TimingSummary
+//
+/**\class TimingSummary TimingSummary.h HBHETimingValidation/MakeTimingMaps/interface/TimingSummary.h
+
+ Description: per-channel time moments for every run and lumi section
+
+ Hits, sum and sum of squares of the times per channel and section of lumisPerSection lumis,
+ written as the TTree "timingSummary" plus a mean time map per run and depth.
+*/
+//
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/HBHEChannelMap.h"
+
+class TDirectory;
+
+struct TimingMoments {
+  double n;
+  double sum;
+  double sum2;
+
+  TimingMoments() : n(0), sum(0), sum2(0) {}
+
+  void fill(double time) {
+    n += 1.0;
+    sum += time;
+    sum2 += time*time;
+  }
+  void merge(const TimingMoments& other) {
+    n += other.n;
+    sum += other.sum;
+    sum2 += other.sum2;
+  }
+  double mean() const;
+  double rms() const;
+};
+
+// one set of moments for every channel of HBHEChannelMap
+class ChannelMoments {
+   public:
+      ChannelMoments() : moments_(HBHEChannelMap::nChannels) {}
+
+      void fill(int channel, double time) { moments_[channel].fill(time); }
+      TimingMoments& operator[](int channel) { return moments_[channel]; }
+      const TimingMoments& operator[](int channel) const { return moments_[channel]; }
+
+      void merge(const ChannelMoments& other);
+      void clear();
+
+   private:
+      std::vector<TimingMoments> moments_;
+};
+
+class TimingSummary {
+   public:
+      struct Section {
+        uint32_t run;
+        uint32_t section;
+        bool operator<(const Section& other) const {
+          return run < other.run || (run == other.run && section < other.section);
+        }
+      };
+
+      explicit TimingSummary(unsigned int lumisPerSection = 10);
+
+      unsigned int lumisPerSection() const { return lumisPerSection_; }
+      uint32_t sectionOf(uint32_t lumi) const { return lumi > 0 ? (lumi-1)/lumisPerSection_ : 0; }
+      uint32_t firstLumi(uint32_t section) const { return section*lumisPerSection_ + 1; }
+      uint32_t lastLumi(uint32_t section) const { return (section+1)*lumisPerSection_; }
+
+      // add the moments of one lumi block
+      void add(uint32_t run, uint32_t lumi, const ChannelMoments& moments);
+      // add another summary, throws std::runtime_error if the sections differ in
+      // size; an empty summary takes the section size of the other
+      void merge(const TimingSummary& other);
+
+      const std::map<Section, ChannelMoments>& sections() const { return sections_; }
+
+      // write the tree and the per-run maps into dir
+      void write(TDirectory* dir) const;
+      // add the content of the tree written by write() into dir, false if there is none
+      bool read(TDirectory* dir);
+
+   private:
+      unsigned int lumisPerSection_;
+      std::map<Section, ChannelMoments> sections_;
+};
+
+#endif
@@ -22,16 +22,10 @@
 using namespace std;
 
 // user include files
-#include "TTree.h"
-#include "TFile.h"
-#include "TProfile.h"
-#include "TH1.h"
-#include "TH2.h"
-#include "TCanvas.h"
-#include "TProfile2D.h"
-
 #include "FWCore/Framework/interface/Frameworkfwd.h"
 #include "FWCore/Framework/interface/EDAnalyzer.h"
+#include "FWCore/Framework/interface/one/EDAnalyzer.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
 #include "FWCore/MessageLogger/interface/MessageLogger.h"
 #include "FWCore/Framework/interface/Event.h"
 
@@ -44,10 +38,11 @@ using namespace std;
 #include "DataFormats/HcalRecHit/interface/HcalRecHitCollections.h"
 #include "DataFormats/HcalDetId/interface/HcalDetId.h"
 
-#include "SimDataFormats/CaloHit/interface/PCaloHit.h"
-#include "SimDataFormats/CaloHit/interface/PCaloHitContainer.h"
-
-#include "SimCalorimetry/HcalSimAlgos/interface/HcalSimParameterMap.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/PulseShapeCapture.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingAccumulator.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingInstrumentation.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingSkim.h"
+#include "HBHETimingValidation/MakeTimingMaps/plugins/TimingParameters.h"
 //
 // class declaration
 //
@@ -58,7 +53,7 @@ using namespace std;
 // constructor "usesResource("TFileService");"
 // This will improve performance in multithreaded jobs.
 
-class MakeTimingMaps : public edm::one::EDAnalyzer<edm::one::SharedResources>  {
+class MakeTimingMaps : public edm::one::EDAnalyzer<edm::one::SharedResources, edm::one::WatchLuminosityBlocks>  {
    public:
       explicit MakeTimingMaps(const edm::ParameterSet&);
       ~MakeTimingMaps();
@@ -69,76 +64,38 @@ class MakeTimingMaps : public edm::one::EDAnalyzer<edm::one::SharedResources>  {
    private:
       virtual void beginJob() override;
       virtual void analyze(const edm::Event&, const edm::EventSetup&) override;
+      virtual void beginLuminosityBlock(const edm::LuminosityBlock&, const edm::EventSetup&) override;
+      virtual void endLuminosityBlock(const edm::LuminosityBlock&, const edm::EventSetup&) override;
       virtual void endJob() override;
       
-      std::string int2string(int i);
-      
-      void ClearVariables();
-      
-      // some variables for storing information
-      double Method0Energy;
-      double RecHitEnergy;
-      double RecHitTime;
-      double LumiBlock;
-      double iEta;
-      double iPhi; 
-      int depth;
-      int RunNumber;
-      int EvtNumber;
-      
       // create the output file
       edm::Service<TFileService> FileService;
       // create the token to retrieve hit information
       edm::EDGetTokenT<HBHERecHitCollection>    hRhToken;
       edm::EDGetTokenT<bool> hIsoToken;
       
-      // 2-d profiles which will hold the average time per channel, 1 for each depth
-      TProfile2D *hHBHETiming_Depth1;
-      TProfile2D *hHBHETiming_Depth2;
-      TProfile2D *hHBHETiming_Depth3;
-      
-      TH2F *occupancy_d1;
-      TH2F *occupancy_d2;
-      TH2F *occupancy_d3;
-      
-      // pointer to pointer to pointers to make a 2-d array of histograms
-      // These are used to hold the individual rechit timing histograms for each channel
-      TH1F ***hTiming_Depth1 = new TH1F**[59];
-      TH1F ***hTiming_Depth2 = new TH1F**[59];
-      TH1F ***hTiming_Depth3 = new TH1F**[6];
+      // all the timing histograms, only written to the output at the end of the job
+      std::unique_ptr<TimingAccumulator> timing_;
+      // rechits of the current event, handed to timing_ in one go
+      RecHitBatch hits_;
+      TDirectory *outDir_;
+      // per-channel time moments of the current lumi block, and per run and lumi section
+      ChannelMoments lumiMoments_;
+      std::unique_ptr<TimingSummary> summary_;
+      // optional compact copy of the rechits, to redo the maps with other cuts
+      std::unique_ptr<TimingSkimWriter> skim_;
       
-      // Check for correlation between same iphi or adjacent iphi
-      TH1F *hCheckTimingPhi67Plus;
-      TH1F *hCheckTiming66to67P;
-      TH2F *hCorrTimingPhi67Plus;
-      TH2F *hCorrTiming66to67P;
+      // ADC time slices of out-of-time or selected hits, only with a pulseCapture PSet
+      std::unique_ptr<PulseShapeCapture> pulses_;
       
-      // Get energy distributions of channels
-      TH1F *hCheckEnergyIT;
-      TH1F *hCheckEnergyOOT1;
-      TH1F *hCheckEnergyOOT2;
+      // stage timers and hit counters, only with instrumentationFile set
+      std::unique_ptr<TimingInstrumentation> instrumentation_;
+      std::string instrumentationFile_;
+      TimingInstrumentation::Clock::time_point jobStart_;
       
-      TH1F *hCheckEnergyITip51;
-      TH1F *hCheckEnergyOOT1ip51;
-      TH1F *hCheckEnergyOOT2ip51;
-      
-      TH1F *hCheckEnergyITip54;
-      TH1F *hCheckEnergyOOT1ip54;
-      TH1F *hCheckEnergyOOT2ip54;
-      
-      // Sample histogram for storing time slice information
-      TH1F *hTimeSlices;
-      
-      int runNumber_;
       double energyCut_;
       double timeLow_;
       double timeHigh_;
-      std::vector<double> etas67;
-      std::vector<double> etas66;
-        
-    // crap for trouble-shooting, create a TCanvas here to print out pulse shapes of problem channels
-   TCanvas *c1 = new TCanvas("c1","c1",900,700);
-   int nProblems = 0;
 };
 
 MakeTimingMaps::MakeTimingMaps(const edm::ParameterSet& iConfig)
@@ -146,244 +103,132 @@ MakeTimingMaps::MakeTimingMaps(const edm::ParameterSet& iConfig)
    //now do what ever initialization is needed
    usesResource("TFileService");
 
-   for (int i = 0; i < 59; ++i){
-    hTiming_Depth1[i] = new TH1F*[72];
-    hTiming_Depth2[i] = new TH1F*[72];
-  }
-  for(int i = 0; i < 6; ++i){
-    hTiming_Depth3[i] = new TH1F*[72]; 
-  }
-  
   // Tell which collection is consumed
   hRhToken = consumes<HBHERecHitCollection >(iConfig.getUntrackedParameter<string>("HBHERecHits","hbhereco"));
   hIsoToken = consumes<bool >(iConfig.getUntrackedParameter<string>("HBHENoiseFilterResultProducer", "HBHEIsoNoiseFilterResult"));
   
 
-  // Get Configurable parameters
-  runNumber_ = iConfig.getParameter<int>("runNumber");
+  // Get Configurable parameters; runNumber is not read, the timing summary
+  // keeps the runs apart
   energyCut_ = iConfig.getParameter<double>("rechitEnergy");
   
   timeLow_ = iConfig.getParameter<double>("timeLowBound");
   timeHigh_ = iConfig.getParameter<double>("timeHighBound");
 
   
-  // book all the 1-d histograms which store the rechit/channel information
-  // this is done is a really ridiculous way and needs to be replaced
-  for(int i = 0; i < 72; ++i){
-    
-    for(int j = 0; j < 59; ++j){
-       hTiming_Depth1[j][i] = FileService->make<TH1F>(("Depth1_ieta"+int2string(j-29)+"_iphi"+int2string(i+1)).c_str(),("Depth1_ieta"+int2string(j-29)+"_iphi"+int2string(i+1)).c_str(),200,-100.0,100.0);
-       hTiming_Depth2[j][i] = FileService->make<TH1F>(("Depth2_ieta"+int2string(j-29)+"_iphi"+int2string(i+1)).c_str(),("Depth2_ieta"+int2string(j-29)+"_iphi"+int2string(i+1)).c_str(),200,-100.0,100.0);
-    } 
-    for(int j = 0; j < 6; ++j){ 
-      // Special thing for Depth #3 because there are only a few strips of channels
-      int eta = 0;
-      if(j==0) eta = -28;
-      if(j==1) eta = -27;
-      if(j==2) eta = -16;
-      if(j==3) eta =  16;
-      if(j==4) eta =  27;
-      if(j==5) eta =  28;
-      hTiming_Depth3[j][i] = FileService->make<TH1F>(("Depth3_ieta"+int2string(eta)+"_iphi"+int2string(i+1)).c_str(),("Depth3_ieta"+int2string(eta)+"_iphi"+int2string(i+1)).c_str(),200,-100.0,100.0);
-    }
-  }
-  
-  // example histogram for storing time slice information
-  hTimeSlices = FileService->make<TH1F>("hTimeSlices","hTimeSlices",10,-100,150); 
-
-  hHBHETiming_Depth1 = FileService->make<TProfile2D>("hHBHETiming_Depth1","hHBHETiming_Depth1",59,-29.5,29.5,72,0.5,72.5, timeLow_, timeHigh_,"s");
-  hHBHETiming_Depth2 = FileService->make<TProfile2D>("hHBHETiming_Depth2","hHBHETiming_Depth2",59,-29.5,29.5,72,0.5,72.5, timeLow_, timeHigh_,"s");
-  hHBHETiming_Depth3 = FileService->make<TProfile2D>("hHBHETiming_Depth3","hHBHETiming_Depth3",59,-29.5,29.5,72,0.5,72.5, timeLow_, timeHigh_,"s");
-  
-  occupancy_d1 = FileService->make<TH2F>("occupancy_d1","occupancy_depth1",59,-29.5,29.5,72,0.5,72.5);
-  occupancy_d2 = FileService->make<TH2F>("occupancy_d2","occupancy_depth2",59,-29.5,29.5,72,0.5,72.5);
-  occupancy_d3 = FileService->make<TH2F>("occupancy_d3","occupancy_depth3",59,-29.5,29.5,72,0.5,72.5);
-  
-  hCheckTimingPhi67Plus = FileService->make<TH1F>("hCheckTimingPhi67Plus","hCheckTimingPhi67Plus",50,-25,25);
-  hCheckTiming66to67P= FileService->make<TH1F>("hCheckTiming66to67P","hCheckTiming66to67P",50,-25,25);
-  
-  hCorrTiming66to67P= FileService->make<TH2F>("hCorrTiming66to67P","hCorrTiming66to67P",100,-25,75,100,-25,75);
-  hCorrTimingPhi67Plus= FileService->make<TH2F>("hCorrTimingPhi67Plus","hCorrTimingPhi67Plus",100,-25,75,100,-25,75);
+  // the per-channel histograms live in one flat array and are only turned into
+  // TH1F for the channels with entries when the job ends
+  TimingAccumulator::Config config(energyCut_, timeLow_, timeHigh_);
+  // same-event correlations, iphi 66/67 unless configured otherwise
+  timingParameters::readCorrelations(iConfig, config);
+  // median/IQR/truncated mean maps, and whether to keep the per-channel histograms
+  timingParameters::readChannelStatistics(iConfig, config);
+  // energy spectra per channel group and time window, IT/OOT1/OOT2 and ip51/ip54 unless configured otherwise
+  timingParameters::readEnergySpectra(iConfig, config);
+  timing_.reset(new TimingAccumulator(config));
+  timing_->setLumiMoments(&lumiMoments_);
+  summary_.reset(new TimingSummary(iConfig.getUntrackedParameter<unsigned int>("lumisPerSection", 10)));
+  outDir_ = FileService->getBareDirectory();
   
-  hCheckEnergyIT= FileService->make<TH1F>("hCheckEnergyIT","hCheckEnergyIT",500,0,1000);
-  hCheckEnergyOOT1= FileService->make<TH1F>("hCheckEnergyOOT1","hCheckEnergyOOT1",500,0,1000);
-  hCheckEnergyOOT2= FileService->make<TH1F>("hCheckEnergyOOT2","hCheckEnergyOOT2",500,0,1000);
+  std::string skimFile = iConfig.getUntrackedParameter<string>("skimFile", "");
+  if(!skimFile.empty()) skim_.reset(new TimingSkimWriter(skimFile));
   
-  hCheckEnergyITip54= FileService->make<TH1F>("hCheckEnergyITip54","hCheckEnergyITip54",300,0,300);
-  hCheckEnergyOOT1ip54= FileService->make<TH1F>("hCheckEnergyOOT1ip54","hCheckEnergyOOT1ip54",300,0,300);
-  hCheckEnergyOOT2ip54= FileService->make<TH1F>("hCheckEnergyOOT2ip54","hCheckEnergyOOT2ip54",300,0,300);
+  // pulse shapes of problem channels, kept in memory and written at the end of the job
+  PulseShapeCapture::Config pulseConfig;
+  if(timingParameters::readPulseCapture(iConfig, pulseConfig)) pulses_.reset(new PulseShapeCapture(pulseConfig));
   
-  hCheckEnergyITip51= FileService->make<TH1F>("hCheckEnergyITip51","hCheckEnergyITip51",300,0,300);
-  hCheckEnergyOOT1ip51= FileService->make<TH1F>("hCheckEnergyOOT1ip51","hCheckEnergyOOT1ip51",300,0,300);
-  hCheckEnergyOOT2ip51= FileService->make<TH1F>("hCheckEnergyOOT2ip51","hCheckEnergyOOT2ip51",300,0,300);
+  // where the time goes, written as JSON at the end of the job
+  instrumentationFile_ = iConfig.getUntrackedParameter<string>("instrumentationFile", "");
+  if(!instrumentationFile_.empty()){
+    instrumentation_.reset(new TimingInstrumentation());
+    timing_->setCounters(&instrumentation_->counters());
+  }
 }
 
 
 MakeTimingMaps::~MakeTimingMaps(){} // destructor
 
-// funtion so you can turn an integer into a string for labels and stuff
-std::string MakeTimingMaps::int2string(int i) {
-  stringstream ss;
-  string ret;
-  ss << i;
-  ss >> ret;
-  return ret;
-}
-
 // ------------ method called for each event  ------------
 void
 MakeTimingMaps::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
 {
   using namespace edm;
+  
+  TimingInstrumentation *instrumentation = instrumentation_.get();
+  const TimingInstrumentation::Clock::time_point eventStart =
+    instrumentation ? TimingInstrumentation::Clock::now() : TimingInstrumentation::Clock::time_point();
 
   // Read events
   Handle<HBHERecHitCollection> hRecHits; // create handle
-  iEvent.getByToken(hRhToken, hRecHits); // get events based on token
+  {
+    StageTimer timer(instrumentation, TimingInstrumentation::kGetRecHits);
+    iEvent.getByToken(hRhToken, hRecHits); // get events based on token
+  }
+  
+  if(skim_) skim_->beginEvent(iEvent.id().run(), iEvent.id().luminosityBlock(), iEvent.id().event());
+  if(pulses_) pulses_->beginEvent(iEvent.id().run(), iEvent.id().luminosityBlock(), iEvent.id().event());
+  
+  StageTimer hitLoopTimer(instrumentation, TimingInstrumentation::kHitLoop);
+  hits_.clear();
+  hits_.reserve(hRecHits->size());
   
   // Loop over all rechits in one event
-  for(int i = 0; i < (int)hRecHits->size(); i++) {
-    ClearVariables(); // sets a bunch of stuff to zero
-    
-    RunNumber = iEvent.id().run(); // get the run number for the event
-    EvtNumber = iEvent.id().event(); // get the event number
-    LumiBlock = iEvent.id().luminosityBlock();
-
-    // Just in case the file you are running over contains events from multiple runs,
-    // remove everything except the run you are interested in
-    //  if(RunNumber != runNumber_) continue;
-    
-    // get ID information for the reconstructed hit
-    HcalDetId detID_rh = (*hRecHits)[i].id().rawId();
-    
+  for(const HBHERecHit& hit : *hRecHits) {
     // ID information can get us detector coordinates
-    depth = (*hRecHits)[i].id().depth();
-    iEta = detID_rh.ieta();
-    iPhi = detID_rh.iphi();
-    
-    // get some variables
-    Method0Energy = (*hRecHits)[i].eraw();
-    RecHitEnergy = (*hRecHits)[i].energy();
-    RecHitTime = (*hRecHits)[i].time();
-
-
-    
-    
-//     // this block of code is to extract the charge in individual time slices from
-//     // the auxiliary information
-//     // Not  used at the moment, but useful for trouble-shooting if we identify a 
-//     //  problem with some channels
-//     int adc[8];
-//     int auxwd1 = (*hRecHits)[i].auxHBHE();  // TS = 0,1,2,3 info
-//     int auxwd2 = (*hRecHits)[i].aux();      // TS = 4,5,6,7 info
-// 
-//     adc[0] = (auxwd1)       & 0x7F;
-//     adc[1] = (auxwd1 >> 7)  & 0x7F;
-//     adc[2] = (auxwd1 >> 14) & 0x7F;
-//     adc[3] = (auxwd1 >> 21) & 0x7F;
-// 
-//     adc[4] = (auxwd2)       & 0x7F;
-//     adc[5] = (auxwd2 >> 7)  & 0x7F;
-//     adc[6] = (auxwd2 >> 14) & 0x7F;
-//     adc[7] = (auxwd2 >> 21) & 0x7F;
-//    
-//     
-//     // example on how to fill the time slices if you need it
-// //  if(RecHitEnergy > 5){
-//      std::cout << "event number is " << EvtNumber << std::endl;
-//      std::cout << "iphi, ieta = " << detID_rh.iphi() << " " << detID_rh.ieta() << " time = " << RecHitTime << " energy = " << RecHitEnergy << std::endl;
-//     for(int nadc = 0; nadc < 8; nadc++){
-//       hTimeSlices->SetBinContent(nadc+1,adc[nadc]);
-//      std::cout << adc[nadc] << "  " ;
-//     }
-//     std::cout << std::endl;
-//     hTimeSlices->Draw();
-//     c1->SaveAs(("test_phi"+int2string(detID_rh.iphi())+"eta"+int2string(detID_rh.ieta())+"energy"+int2string((int)RecHitEnergy)+"time"+int2string((int)RecHitTime)+".png").c_str());
-//     ++nProblems;
-//    }
-
-
-   
-    if(iEta < 0 && iEta > -16 && (iPhi == 51)){
-      if(RecHitTime > -5 && RecHitTime < 5) hCheckEnergyITip51->Fill(RecHitEnergy);
-      if(RecHitTime >  6 && RecHitTime < 12) hCheckEnergyOOT1ip51->Fill(RecHitEnergy);
-      if(RecHitTime > 12 && RecHitTime < 20) hCheckEnergyOOT2ip51->Fill(RecHitEnergy);
-    }
+    HcalDetId detID_rh = hit.id();
+    const int ieta = detID_rh.ieta(), iphi = detID_rh.iphi(), depth = detID_rh.depth();
     
-    if(iEta < 0 && iEta > -16 && (iPhi == 54)){
-      if(RecHitTime > -5 && RecHitTime < 5) hCheckEnergyITip54->Fill(RecHitEnergy);
-      if(RecHitTime >  6 && RecHitTime < 12) hCheckEnergyOOT1ip54->Fill(RecHitEnergy);
-      if(RecHitTime > 12 && RecHitTime < 20) hCheckEnergyOOT2ip54->Fill(RecHitEnergy);
-    }
-
-      if(RecHitTime > -5 && RecHitTime < 5) hCheckEnergyIT->Fill(RecHitEnergy);
-      if(RecHitTime >  6 && RecHitTime < 12) hCheckEnergyOOT1->Fill(RecHitEnergy);
-      if(RecHitTime > 12 && RecHitTime < 20) hCheckEnergyOOT2->Fill(RecHitEnergy);
+    // charge in the individual time slices, for trouble-shooting problem channels
+    if(pulses_) pulses_->fill(ieta, iphi, depth, hit.energy(), hit.time(), hit.auxHBHE(), hit.aux());
 
-
-    // only get timing information from rechits with high enough energy
-    if(RecHitEnergy > energyCut_) {
-      
-      if(depth==1){// fill depth1
-        hHBHETiming_Depth1->Fill(detID_rh.ieta(), detID_rh.iphi(), RecHitTime);
-        occupancy_d1->Fill(detID_rh.ieta(), detID_rh.iphi(),1);
-        hTiming_Depth1[detID_rh.ieta()+29][detID_rh.iphi()-1]->Fill(RecHitTime);
-        
-        if(detID_rh.iphi() == 67 && detID_rh.ieta() > 0 && detID_rh.ieta() <= 16){
-          etas67.push_back(RecHitTime); 
-        }
-        if(detID_rh.iphi() == 66 && detID_rh.ieta() > 0 && detID_rh.ieta() <= 16){
-          etas66.push_back(RecHitTime); 
-        }
-        
-      } else if(depth==2){// fill depth 2
-        hHBHETiming_Depth2->Fill(detID_rh.ieta(), detID_rh.iphi(), RecHitTime);
-        occupancy_d2->Fill(detID_rh.ieta(), detID_rh.iphi(),1);
-        hTiming_Depth2[detID_rh.ieta()+29][detID_rh.iphi()-1]->Fill(RecHitTime);
-      } else if(depth==3){
-        hHBHETiming_Depth3->Fill(detID_rh.ieta(), detID_rh.iphi(), RecHitTime);
-        occupancy_d3->Fill(detID_rh.ieta(), detID_rh.iphi(),1);
-        
-        int bin = 0;
-        if(detID_rh.ieta() == -28) bin = 0;
-        if(detID_rh.ieta() == -27) bin = 1;
-        if(detID_rh.ieta() == -16) bin = 2;
-        if(detID_rh.ieta() ==  16) bin = 3;
-        if(detID_rh.ieta() ==  27) bin = 4;
-        if(detID_rh.ieta() ==  28) bin = 5;
-        hTiming_Depth3[bin][detID_rh.iphi()-1]->Fill(RecHitTime);
-      }
-    }
+    hits_.push_back(ieta, iphi, depth, hit.energy(), hit.time());
+    if(skim_) skim_->addHit(detID_rh.rawId(), hit.energy(), hit.eraw(), hit.time(), hit.auxHBHE(), hit.aux());
   }
+  hitLoopTimer.stop();
   
-  for(int i = 0; i< (int)etas67.size() ; ++i){
-    for(int j = i+1; j< (int)etas67.size() ; ++j){
-      hCheckTimingPhi67Plus->Fill(etas67[i]-etas67[j]);
-      hCorrTimingPhi67Plus->Fill(etas67[i],etas67[j]);
-    }
-    for(int j = 0; j < (int)etas66.size() ; ++j){
-      hCheckTiming66to67P->Fill(etas67[i]-etas66[j]);
-      hCorrTiming66to67P->Fill(etas67[i],etas66[j]);
-    }
+  // fill all the hits of the event, then the same-event timing correlations
+  {
+    StageTimer timer(instrumentation, TimingInstrumentation::kFill);
+    timing_->fill(hits_);
   }
+  {
+    StageTimer timer(instrumentation, TimingInstrumentation::kCorrelations);
+    timing_->endEvent();
+  }
+  if(skim_) skim_->endEvent();
   
-  etas66.clear();
-  etas67.clear();
+  if(instrumentation) instrumentation->addEvent(TimingInstrumentation::Clock::now() - eventStart);
 }
 
 
+// ------------ method called when starting to process a luminosity block  ------------
+void MakeTimingMaps::beginLuminosityBlock(const edm::LuminosityBlock&, const edm::EventSetup&){
+  lumiMoments_.clear();
+}
+
+// ------------ method called when ending the processing of a luminosity block  ------------
+void MakeTimingMaps::endLuminosityBlock(const edm::LuminosityBlock& iLumi, const edm::EventSetup&){
+  summary_->add(iLumi.run(), iLumi.luminosityBlock(), lumiMoments_);
+}
+
 // ------------ method called once each job just before starting event loop  ------------
-void MakeTimingMaps::beginJob(){}
+void MakeTimingMaps::beginJob(){
+  jobStart_ = TimingInstrumentation::Clock::now();
+}
 
 // ------------ method called once each job just after ending the event loop  ------------
-void MakeTimingMaps::endJob(){}
-
-void MakeTimingMaps::ClearVariables(){
- RecHitEnergy = 0;
- RunNumber = 0;
- depth=0;
- iEta = 0;
- iPhi = 0;
- RecHitTime = 0;
+void MakeTimingMaps::endJob(){
+  {
+    StageTimer timer(instrumentation_.get(), TimingInstrumentation::kWrite);
+    timing_->write(outDir_);
+    summary_->write(outDir_);
+    if(pulses_) pulses_->write(outDir_);
+    if(skim_) skim_->flush();
+  }
+  if(instrumentation_){
+    double jobSeconds = std::chrono::duration<double>(TimingInstrumentation::Clock::now() - jobStart_).count();
+    instrumentation_->writeSummary(instrumentationFile_, moduleDescription().moduleLabel(), 1, jobSeconds);
+  }
 }
 
 // ------------ method fills 'descriptions' with the allowed parameters for the module  ------------
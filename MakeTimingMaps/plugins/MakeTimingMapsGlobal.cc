@@ -0,0 +1,291 @@
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+// Class:      MakeTimingMapsGlobal
+//
+/**\class MakeTimingMapsGlobal MakeTimingMapsGlobal.cc HBHETimingValidation/MakeTimingMaps/plugins/MakeTimingMapsGlobal.cc
+
+ Description: multithreaded version of MakeTimingMaps
+
+ Every stream fills its own TimingAccumulator, so events are never serialized
+ through the module. The stream copies are added together at the end of each
+ stream and the merged histograms are handed to TFileService in endJob.
+ Per-channel time moments are also kept per lumi block (LuminosityBlockSummaryCache)
+ and collected per run and lumi section into a TimingSummary.
+ With skimFile set, every stream also writes its rechits to its own
+ TimingSkim file, which timingSkimToMaps can turn back into maps. With a
+ pulseCapture PSet every stream keeps its own PulseShapeCapture, merged like
+ the histograms. With instrumentationFile set every stream times its stages
+ and counts its hits (TimingInstrumentation), and the sum over the streams
+ is written to that file as JSON in endJob.
+*/
+//
+
+
+// system include files
+#include <memory>
+#include <mutex>
+#include <string>
+
+// user include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/global/EDAnalyzer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
+
+#include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ParameterSet/interface/ConfigurationDescriptions.h"
+#include "FWCore/ParameterSet/interface/ParameterSetDescription.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+
+#include "DataFormats/HcalRecHit/interface/HBHERecHit.h"
+#include "DataFormats/HcalRecHit/interface/HcalRecHitCollections.h"
+#include "DataFormats/HcalDetId/interface/HcalDetId.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/PulseShapeCapture.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingAccumulator.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingInstrumentation.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingSkim.h"
+#include "HBHETimingValidation/MakeTimingMaps/plugins/TimingParameters.h"
+//
+// class declaration
+//
+
+// everything a single stream fills
+struct TimingStreamData {
+  explicit TimingStreamData(const TimingAccumulator::Config& config) : timing(config) {
+    timing.setLumiMoments(&lumiMoments);
+  }
+
+  TimingAccumulator timing;
+  // rechits of the event being processed, reused from event to event
+  RecHitBatch hits;
+  // moments of the lumi block the stream is in
+  ChannelMoments lumiMoments;
+  // only there if a skim file was asked for, one file per stream
+  std::unique_ptr<TimingSkimWriter> skim;
+  // only there with a pulseCapture PSet
+  std::unique_ptr<PulseShapeCapture> pulses;
+  // only there with instrumentationFile set
+  std::unique_ptr<TimingInstrumentation> instrumentation;
+};
+
+class MakeTimingMapsGlobal : public edm::global::EDAnalyzer<edm::StreamCache<TimingStreamData>,
+                                                            edm::LuminosityBlockSummaryCache<ChannelMoments> >  {
+   public:
+      explicit MakeTimingMapsGlobal(const edm::ParameterSet&);
+
+      static void fillDescriptions(edm::ConfigurationDescriptions& descriptions);
+
+
+   private:
+      std::unique_ptr<TimingStreamData> beginStream(edm::StreamID) const override;
+      void analyze(edm::StreamID, const edm::Event&, const edm::EventSetup&) const override;
+      void endStream(edm::StreamID) const override;
+      std::shared_ptr<ChannelMoments> globalBeginLuminosityBlockSummary(const edm::LuminosityBlock&, const edm::EventSetup&) const override;
+      void streamEndLuminosityBlockSummary(edm::StreamID, const edm::LuminosityBlock&, const edm::EventSetup&, ChannelMoments*) const override;
+      void globalEndLuminosityBlockSummary(const edm::LuminosityBlock&, const edm::EventSetup&, ChannelMoments*) const override;
+      void beginJob() override;
+      void endJob() override;
+
+      // create the token to retrieve hit information
+      edm::EDGetTokenT<HBHERecHitCollection> hRhToken;
+      // declared as in MakeTimingMaps, so both accept the same configuration
+      edm::EDGetTokenT<bool> hIsoToken;
+
+      TimingAccumulator::Config config_;
+      std::string skimFile_;
+      bool capturePulses_;
+      PulseShapeCapture::Config pulseConfig_;
+      std::string instrumentationFile_;
+      TimingInstrumentation::Clock::time_point jobStart_;
+
+      // directory of this module in the TFileService output, taken at construction
+      TDirectory *outDir_;
+
+      // sum over all streams which have finished so far
+      mutable std::mutex mergeMutex_;
+      mutable std::unique_ptr<TimingAccumulator> merged_;
+      mutable std::unique_ptr<PulseShapeCapture> mergedPulses_;
+      mutable std::unique_ptr<TimingInstrumentation> mergedInstrumentation_;
+      mutable unsigned int nStreamsMerged_;
+      // per run and lumi section moments of all the lumi blocks which are done
+      mutable TimingSummary summary_;
+};
+
+MakeTimingMapsGlobal::MakeTimingMapsGlobal(const edm::ParameterSet& iConfig) :
+  nStreamsMerged_(0),
+  summary_(iConfig.getUntrackedParameter<unsigned int>("lumisPerSection"))
+{
+  // Tell which collection is consumed
+  hRhToken = consumes<HBHERecHitCollection>(iConfig.getUntrackedParameter<std::string>("HBHERecHits"));
+  hIsoToken = consumes<bool>(iConfig.getUntrackedParameter<std::string>("HBHENoiseFilterResultProducer"));
+
+  // Get Configurable parameters
+  config_.energyCut = iConfig.getParameter<double>("rechitEnergy");
+  config_.timeLow = iConfig.getParameter<double>("timeLowBound");
+  config_.timeHigh = iConfig.getParameter<double>("timeHighBound");
+  timingParameters::readCorrelations(iConfig, config_);
+  timingParameters::readChannelStatistics(iConfig, config_);
+  timingParameters::readEnergySpectra(iConfig, config_);
+  skimFile_ = iConfig.getUntrackedParameter<std::string>("skimFile");
+  capturePulses_ = timingParameters::readPulseCapture(iConfig, pulseConfig_);
+  instrumentationFile_ = iConfig.getUntrackedParameter<std::string>("instrumentationFile");
+
+  // TFileService knows which module is being set up here, so ask for the
+  // directory now and only write into it once all the streams are merged
+  edm::Service<TFileService> FileService;
+  outDir_ = FileService->getBareDirectory();
+}
+
+std::unique_ptr<TimingStreamData> MakeTimingMapsGlobal::beginStream(edm::StreamID sid) const {
+  auto data = std::make_unique<TimingStreamData>(config_);
+  if(!skimFile_.empty()){
+    // skim.htsk -> skim_stream0.htsk, skim_stream1.htsk, ...
+    std::string name = skimFile_;
+    std::string::size_type dot = name.rfind('.');
+    if(dot == std::string::npos || name.find('/', dot) != std::string::npos) dot = name.size();
+    name.insert(dot, "_stream"+std::to_string(sid.value()));
+    data->skim = std::make_unique<TimingSkimWriter>(name);
+  }
+  if(capturePulses_) data->pulses = std::make_unique<PulseShapeCapture>(pulseConfig_);
+  if(!instrumentationFile_.empty()){
+    data->instrumentation = std::make_unique<TimingInstrumentation>();
+    data->timing.setCounters(&data->instrumentation->counters());
+  }
+  return data;
+}
+
+// ------------ method called for each event  ------------
+void
+MakeTimingMapsGlobal::analyze(edm::StreamID sid, const edm::Event& iEvent, const edm::EventSetup& iSetup) const
+{
+  using namespace edm;
+
+  TimingStreamData *data = streamCache(sid);
+  TimingSkimWriter *skim = data->skim.get();
+  PulseShapeCapture *pulses = data->pulses.get();
+  TimingInstrumentation *instrumentation = data->instrumentation.get();
+  const TimingInstrumentation::Clock::time_point eventStart =
+    instrumentation ? TimingInstrumentation::Clock::now() : TimingInstrumentation::Clock::time_point();
+
+  // Read events
+  Handle<HBHERecHitCollection> hRecHits; // create handle
+  {
+    StageTimer timer(instrumentation, TimingInstrumentation::kGetRecHits);
+    iEvent.getByToken(hRhToken, hRecHits); // get events based on token
+  }
+
+  if(skim) skim->beginEvent(iEvent.id().run(), iEvent.id().luminosityBlock(), iEvent.id().event());
+  if(pulses) pulses->beginEvent(iEvent.id().run(), iEvent.id().luminosityBlock(), iEvent.id().event());
+
+  StageTimer hitLoopTimer(instrumentation, TimingInstrumentation::kHitLoop);
+  data->hits.clear();
+  data->hits.reserve(hRecHits->size());
+
+  // Loop over all rechits in one event
+  for(const HBHERecHit& hit : *hRecHits) {
+    HcalDetId detID_rh = hit.id();
+    data->hits.push_back(detID_rh.ieta(), detID_rh.iphi(), detID_rh.depth(), hit.energy(), hit.time());
+    if(skim) skim->addHit(detID_rh.rawId(), hit.energy(), hit.eraw(), hit.time(), hit.auxHBHE(), hit.aux());
+    if(pulses) pulses->fill(detID_rh.ieta(), detID_rh.iphi(), detID_rh.depth(), hit.energy(), hit.time(), hit.auxHBHE(), hit.aux());
+  }
+  hitLoopTimer.stop();
+  {
+    StageTimer timer(instrumentation, TimingInstrumentation::kFill);
+    data->timing.fill(data->hits);
+  }
+  {
+    StageTimer timer(instrumentation, TimingInstrumentation::kCorrelations);
+    data->timing.endEvent();
+  }
+  if(skim) skim->endEvent();
+
+  if(instrumentation) instrumentation->addEvent(TimingInstrumentation::Clock::now() - eventStart);
+}
+
+void MakeTimingMapsGlobal::endStream(edm::StreamID sid) const {
+  TimingStreamData *data = streamCache(sid);
+  if(data->skim) data->skim->flush();
+
+  std::lock_guard<std::mutex> lock(mergeMutex_);
+  if(!merged_) merged_ = std::make_unique<TimingAccumulator>(config_);
+  merged_->merge(data->timing);
+  if(data->pulses){
+    if(!mergedPulses_) mergedPulses_ = std::make_unique<PulseShapeCapture>(pulseConfig_);
+    mergedPulses_->merge(*data->pulses);
+  }
+  if(data->instrumentation){
+    if(!mergedInstrumentation_) mergedInstrumentation_ = std::make_unique<TimingInstrumentation>();
+    mergedInstrumentation_->merge(*data->instrumentation);
+  }
+  ++nStreamsMerged_;
+}
+
+std::shared_ptr<ChannelMoments> MakeTimingMapsGlobal::globalBeginLuminosityBlockSummary(const edm::LuminosityBlock&, const edm::EventSetup&) const {
+  return std::make_shared<ChannelMoments>();
+}
+
+void MakeTimingMapsGlobal::streamEndLuminosityBlockSummary(edm::StreamID sid, const edm::LuminosityBlock&, const edm::EventSetup&, ChannelMoments* lumiMoments) const {
+  // the framework does not run this concurrently for the same lumi block
+  TimingStreamData *data = streamCache(sid);
+  lumiMoments->merge(data->lumiMoments);
+  data->lumiMoments.clear();
+}
+
+void MakeTimingMapsGlobal::globalEndLuminosityBlockSummary(const edm::LuminosityBlock& iLumi, const edm::EventSetup&, ChannelMoments* lumiMoments) const {
+  std::lock_guard<std::mutex> lock(mergeMutex_);
+  summary_.add(iLumi.run(), iLumi.luminosityBlock(), *lumiMoments);
+}
+
+// ------------ method called once each job just before starting event loop  ------------
+void MakeTimingMapsGlobal::beginJob(){
+  jobStart_ = TimingInstrumentation::Clock::now();
+}
+
+// ------------ method called once each job just after ending the event loop  ------------
+void MakeTimingMapsGlobal::endJob(){
+  {
+    StageTimer timer(mergedInstrumentation_.get(), TimingInstrumentation::kWrite);
+    if(merged_) merged_->write(outDir_);
+    summary_.write(outDir_);
+    if(mergedPulses_) mergedPulses_->write(outDir_);
+  }
+  if(mergedInstrumentation_){
+    double jobSeconds = std::chrono::duration<double>(TimingInstrumentation::Clock::now() - jobStart_).count();
+    mergedInstrumentation_->writeSummary(instrumentationFile_, moduleDescription().moduleLabel(), nStreamsMerged_, jobSeconds);
+  }
+}
+
+// ------------ method fills 'descriptions' with the allowed parameters for the module  ------------
+void MakeTimingMapsGlobal::fillDescriptions(edm::ConfigurationDescriptions& descriptions) {
+  edm::ParameterSetDescription desc;
+  desc.addUntracked<std::string>("HBHERecHits", "hbhereco");
+  desc.addUntracked<std::string>("HBHENoiseFilterResultProducer", "HBHEIsoNoiseFilterResult");
+  // ignored by both modules, the timing summary keeps the runs apart; only
+  // described so the existing configurations, which set it, still load
+  desc.add<int>("runNumber", 0);
+  desc.add<double>("rechitEnergy", 5.0);
+  desc.add<double>("timeLowBound", -12.5);
+  desc.add<double>("timeHighBound", 12.5);
+  // same-event time correlations between groups of channels, see TimingParameters.h
+  timingParameters::addCorrelationDescriptions(desc);
+  // robust per-channel time maps, and the per-channel histograms which production jobs can drop
+  timingParameters::addChannelStatisticsDescriptions(desc);
+  // energy spectra of channel groups in time windows, see EnergySpectra.h
+  timingParameters::addEnergySpectraDescriptions(desc);
+  // number of consecutive lumi blocks summed into one section of the timing summary
+  desc.addUntracked<unsigned int>("lumisPerSection", 10);
+  // write the rechits to a compact columnar file as well, see TimingSkim.h
+  desc.addUntracked<std::string>("skimFile", "");
+  // ADC time slices of out-of-time or selected hits, see PulseShapeCapture.h
+  timingParameters::addPulseCaptureDescription(desc);
+  // JSON file with the time per stage and event and the hit counts, none if empty
+  desc.addUntracked<std::string>("instrumentationFile", "");
+  descriptions.add("makeTimingMapsGlobal", desc);
+}
+
+//define this as a plug-in
+DEFINE_FWK_MODULE(MakeTimingMapsGlobal);
@@ -0,0 +1,231 @@
+#ifndef HBHETimingValidation_MakeTimingMaps_TimingParameters_h
+#define HBHETimingValidation_MakeTimingMaps_TimingParameters_h
+// -*- C++ -*-
+//
+// Package:    HBHETimingValidation/MakeTimingMaps
+//
+// Reading the correlation, channel statistics and energy spectra settings of
+// TimingAccumulator::Config and the pulse shape capture from the module
+// configuration, shared by MakeTimingMaps and MakeTimingMapsGlobal.
+//
+//   correlationTimeBins/Low/High   time axis of the correlation histograms
+//   correlationMaxShift            time differences up to this many bins
+//   correlations                   VPSet of { name, groupA, groupB }, each group
+//                                  { depth = vint32, ietaLow, ietaHigh, iphi = vint32 }
+//   channelHistograms              book the 200-bin time histogram of every channel
+//   quantileTimeBins/Low/High      time axis of the per-channel quantile sketch
+//   truncatedFraction              fraction dropped on each side for the truncated mean
+//   spectrumWindows                VPSet of { name, low, high }, time windows of the spectra
+//   spectrumGroups                 VPSet of { name, nBins, low, high, optional channels = group },
+//                                  energy spectra hCheckEnergy<window><name>, all channels
+//                                  without a channels PSet
+//   pulseCapture                   optional PSet { energyCut, timeLow, timeHigh,
+//                                  channels = VPSet of groups, maxCaptures }, see
+//                                  PulseShapeCapture.h; no capture without it
+//
+// python/timingCorrelations_cff.py has helpers to write the groups,
+// python/energySpectra_cff.py the defaults of the spectra.
+//
+
+#include <string>
+#include <vector>
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ParameterSet/interface/ParameterSetDescription.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/PulseShapeCapture.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingAccumulator.h"
+
+namespace timingParameters {
+
+  inline edm::ParameterSet groupToPSet(const TimingCorrelations::Group& group) {
+    edm::ParameterSet pset;
+    pset.addParameter<std::vector<int> >("depth", group.depths);
+    pset.addParameter<int>("ietaLow", group.ietaLow);
+    pset.addParameter<int>("ietaHigh", group.ietaHigh);
+    pset.addParameter<std::vector<int> >("iphi", group.iphis);
+    return pset;
+  }
+
+  inline TimingCorrelations::Group groupFromPSet(const edm::ParameterSet& pset) {
+    TimingCorrelations::Group group;
+    group.depths = pset.getParameter<std::vector<int> >("depth");
+    group.ietaLow = pset.getParameter<int>("ietaLow");
+    group.ietaHigh = pset.getParameter<int>("ietaHigh");
+    group.iphis = pset.getParameter<std::vector<int> >("iphi");
+    return group;
+  }
+
+  // the correlation settings, the defaults of TimingAccumulator::Config where
+  // they are not in the configuration
+  inline void readCorrelations(const edm::ParameterSet& iConfig, TimingAccumulator::Config& config) {
+    TimingCorrelations::Axis& axis = config.correlationAxis;
+    if(iConfig.existsAs<int>("correlationTimeBins")) axis.nBins = iConfig.getParameter<int>("correlationTimeBins");
+    if(iConfig.existsAs<double>("correlationTimeLow")) axis.low = iConfig.getParameter<double>("correlationTimeLow");
+    if(iConfig.existsAs<double>("correlationTimeHigh")) axis.high = iConfig.getParameter<double>("correlationTimeHigh");
+    if(iConfig.existsAs<int>("correlationMaxShift")) axis.maxShift = iConfig.getParameter<int>("correlationMaxShift");
+
+    if(!iConfig.existsAs<std::vector<edm::ParameterSet> >("correlations")) return;
+    config.correlations.clear();
+    for(const edm::ParameterSet& pset : iConfig.getParameter<std::vector<edm::ParameterSet> >("correlations")){
+      TimingCorrelations::Pair pair;
+      pair.name = pset.getParameter<std::string>("name");
+      pair.a = groupFromPSet(pset.getParameter<edm::ParameterSet>("groupA"));
+      pair.b = groupFromPSet(pset.getParameter<edm::ParameterSet>("groupB"));
+      config.correlations.push_back(pair);
+    }
+  }
+
+  inline void addCorrelationDescriptions(edm::ParameterSetDescription& desc) {
+    TimingCorrelations::Axis axis;
+    desc.add<int>("correlationTimeBins", axis.nBins);
+    desc.add<double>("correlationTimeLow", axis.low);
+    desc.add<double>("correlationTimeHigh", axis.high);
+    desc.add<int>("correlationMaxShift", axis.maxShift);
+
+    edm::ParameterSetDescription group;
+    group.add<std::vector<int> >("depth");
+    group.add<int>("ietaLow");
+    group.add<int>("ietaHigh");
+    group.add<std::vector<int> >("iphi");
+
+    edm::ParameterSetDescription pair;
+    pair.add<std::string>("name");
+    pair.add<edm::ParameterSetDescription>("groupA", group);
+    pair.add<edm::ParameterSetDescription>("groupB", group);
+
+    std::vector<edm::ParameterSet> defaults;
+    for(const TimingCorrelations::Pair& p : TimingCorrelations::defaultPairs()){
+      edm::ParameterSet pset;
+      pset.addParameter<std::string>("name", p.name);
+      pset.addParameter<edm::ParameterSet>("groupA", groupToPSet(p.a));
+      pset.addParameter<edm::ParameterSet>("groupB", groupToPSet(p.b));
+      defaults.push_back(pset);
+    }
+    desc.addVPSet("correlations", pair, defaults);
+  }
+
+  // the per-channel time statistics, the defaults of TimingAccumulator::Config
+  // where they are not in the configuration
+  inline void readChannelStatistics(const edm::ParameterSet& iConfig, TimingAccumulator::Config& config) {
+    if(iConfig.existsAs<bool>("channelHistograms")) config.channelHistograms = iConfig.getParameter<bool>("channelHistograms");
+    ChannelTimeQuantiles::Axis& axis = config.quantileAxis;
+    if(iConfig.existsAs<int>("quantileTimeBins")) axis.nBins = iConfig.getParameter<int>("quantileTimeBins");
+    if(iConfig.existsAs<double>("quantileTimeLow")) axis.low = iConfig.getParameter<double>("quantileTimeLow");
+    if(iConfig.existsAs<double>("quantileTimeHigh")) axis.high = iConfig.getParameter<double>("quantileTimeHigh");
+    if(iConfig.existsAs<double>("truncatedFraction")) config.truncatedFraction = iConfig.getParameter<double>("truncatedFraction");
+  }
+
+  inline void addChannelStatisticsDescriptions(edm::ParameterSetDescription& desc) {
+    TimingAccumulator::Config config;
+    desc.add<bool>("channelHistograms", config.channelHistograms);
+    desc.add<int>("quantileTimeBins", config.quantileAxis.nBins);
+    desc.add<double>("quantileTimeLow", config.quantileAxis.low);
+    desc.add<double>("quantileTimeHigh", config.quantileAxis.high);
+    desc.add<double>("truncatedFraction", config.truncatedFraction);
+  }
+
+  // the energy spectra, the defaults of TimingAccumulator::Config (IT/OOT1/OOT2
+  // for all channels, ip51 and ip54) where they are not in the configuration
+  inline void readEnergySpectra(const edm::ParameterSet& iConfig, TimingAccumulator::Config& config) {
+    if(iConfig.existsAs<std::vector<edm::ParameterSet> >("spectrumWindows")){
+      config.spectrumWindows.clear();
+      for(const edm::ParameterSet& pset : iConfig.getParameter<std::vector<edm::ParameterSet> >("spectrumWindows")){
+        EnergySpectra::Window window;
+        window.name = pset.getParameter<std::string>("name");
+        window.low = pset.getParameter<double>("low");
+        window.high = pset.getParameter<double>("high");
+        config.spectrumWindows.push_back(window);
+      }
+    }
+    if(iConfig.existsAs<std::vector<edm::ParameterSet> >("spectrumGroups")){
+      config.spectrumGroups.clear();
+      for(const edm::ParameterSet& pset : iConfig.getParameter<std::vector<edm::ParameterSet> >("spectrumGroups")){
+        EnergySpectra::Group group;
+        group.name = pset.getParameter<std::string>("name");
+        group.nBins = pset.getParameter<int>("nBins");
+        group.low = pset.getParameter<double>("low");
+        group.high = pset.getParameter<double>("high");
+        group.allChannels = !pset.existsAs<edm::ParameterSet>("channels");
+        if(!group.allChannels) group.channels = groupFromPSet(pset.getParameter<edm::ParameterSet>("channels"));
+        config.spectrumGroups.push_back(group);
+      }
+    }
+  }
+
+  inline void addEnergySpectraDescriptions(edm::ParameterSetDescription& desc) {
+    edm::ParameterSetDescription window;
+    window.add<std::string>("name");
+    window.add<double>("low");
+    window.add<double>("high");
+    std::vector<edm::ParameterSet> windows;
+    for(const EnergySpectra::Window& w : EnergySpectra::defaultWindows()){
+      edm::ParameterSet pset;
+      pset.addParameter<std::string>("name", w.name);
+      pset.addParameter<double>("low", w.low);
+      pset.addParameter<double>("high", w.high);
+      windows.push_back(pset);
+    }
+    desc.addVPSet("spectrumWindows", window, windows);
+
+    edm::ParameterSetDescription channels;
+    channels.add<std::vector<int> >("depth");
+    channels.add<int>("ietaLow");
+    channels.add<int>("ietaHigh");
+    channels.add<std::vector<int> >("iphi");
+
+    edm::ParameterSetDescription group;
+    group.add<std::string>("name");
+    group.add<int>("nBins");
+    group.add<double>("low");
+    group.add<double>("high");
+    group.addOptional<edm::ParameterSetDescription>("channels", channels);
+    std::vector<edm::ParameterSet> groups;
+    for(const EnergySpectra::Group& g : EnergySpectra::defaultGroups()){
+      edm::ParameterSet pset;
+      pset.addParameter<std::string>("name", g.name);
+      pset.addParameter<int>("nBins", g.nBins);
+      pset.addParameter<double>("low", g.low);
+      pset.addParameter<double>("high", g.high);
+      if(!g.allChannels) pset.addParameter<edm::ParameterSet>("channels", groupToPSet(g.channels));
+      groups.push_back(pset);
+    }
+    desc.addVPSet("spectrumGroups", group, groups);
+  }
+
+  // the pulse capture settings, false if the module has no pulseCapture PSet
+  inline bool readPulseCapture(const edm::ParameterSet& iConfig, PulseShapeCapture::Config& config) {
+    if(!iConfig.existsAs<edm::ParameterSet>("pulseCapture")) return false;
+    const edm::ParameterSet& pset = iConfig.getParameter<edm::ParameterSet>("pulseCapture");
+    if(pset.existsAs<double>("energyCut")) config.energyCut = pset.getParameter<double>("energyCut");
+    if(pset.existsAs<double>("timeLow")) config.timeLow = pset.getParameter<double>("timeLow");
+    if(pset.existsAs<double>("timeHigh")) config.timeHigh = pset.getParameter<double>("timeHigh");
+    if(pset.existsAs<unsigned int>("maxCaptures")) config.maxCaptures = pset.getParameter<unsigned int>("maxCaptures");
+    if(pset.existsAs<std::vector<edm::ParameterSet> >("channels")){
+      for(const edm::ParameterSet& group : pset.getParameter<std::vector<edm::ParameterSet> >("channels")){
+        config.channels.push_back(groupFromPSet(group));
+      }
+    }
+    return true;
+  }
+
+  inline void addPulseCaptureDescription(edm::ParameterSetDescription& desc) {
+    PulseShapeCapture::Config config;
+    edm::ParameterSetDescription group;
+    group.add<std::vector<int> >("depth");
+    group.add<int>("ietaLow");
+    group.add<int>("ietaHigh");
+    group.add<std::vector<int> >("iphi");
+
+    edm::ParameterSetDescription pulse;
+    pulse.add<double>("energyCut", config.energyCut);
+    pulse.add<double>("timeLow", config.timeLow);
+    pulse.add<double>("timeHigh", config.timeHigh);
+    pulse.addVPSet("channels", group, std::vector<edm::ParameterSet>());
+    pulse.add<unsigned int>("maxCaptures", config.maxCaptures);
+    desc.addOptional<edm::ParameterSetDescription>("pulseCapture", pulse);
+  }
+
+}
+
+#endif
@@ -37,6 +37,31 @@ process.timingMaps.runNumber = cms.int32(273450)
 process.timingMaps.rechitEnergy = cms.double(5.0)
 process.timingMaps.timeLowBound = cms.double(-12.5)
 process.timingMaps.timeHighBound = cms.double(12.5)
+# median/IQR/truncated mean maps (hTimeMedian_Depth* ...) are always made; production jobs can drop
+# the 200-bin time histogram of every channel
+#process.timingMaps.channelHistograms = cms.bool(False)
+# also write the rechits to a compact skim, timingSkimToMaps redoes the maps from it with other cuts
+#process.timingMaps.skimFile = cms.untracked.string('run2016B_HLT.htsk')
+# time per stage (getRecHits, hitLoop, fill, correlations, write), per-event latency histogram and
+# hit counts by energy cut, depth and time window, as JSON at the end of the job
+#process.timingMaps.instrumentationFile = cms.untracked.string('run2016B_HLT_timing.json')
+# same-event time correlations, iphi 67 vs 66 in HB+ by default; to look at all neighbouring iphi slices
+#from HBHETimingValidation.MakeTimingMaps.timingCorrelations_cff import neighbourPhiCorrelations
+#process.timingMaps.correlations = neighbourPhiCorrelations(depth=[1], ietaLow=1, ietaHigh=16)
+# energy spectra per channel group and time window, IT/OOT1/OOT2 x (all, ip51, ip54) by default;
+# e.g. one more group per iphi slice of HB-
+#from HBHETimingValidation.MakeTimingMaps.energySpectra_cff import phiSliceSpectra
+#process.timingMaps.spectrumGroups = phiSliceSpectra(range(49, 57), ietaLow=-16, ietaHigh=-1)
+# ADC time slices of hits above energyCut which are out of time or in one of the channel groups:
+# average shapes per channel (pulseShapes/) and the samples of the last maxCaptures hits (pulseCaptures tree)
+#from HBHETimingValidation.MakeTimingMaps.timingCorrelations_cff import channelGroup
+#process.timingMaps.pulseCapture = cms.PSet(
+#    energyCut = cms.double(20.0),
+#    timeLow = cms.double(-12.5),
+#    timeHigh = cms.double(12.5),
+#    channels = cms.VPSet(channelGroup([51, 54], ietaLow=-15, ietaHigh=-1)),
+#    maxCaptures = cms.uint32(1000)
+#)
 
 process.TFileService = cms.Service('TFileService', fileName = cms.string('run2016B_HLT.root') )
 
@@ -0,0 +1,83 @@
+import FWCore.ParameterSet.Config as cms
+import FWCore.ParameterSet.VarParsing as VarParsing
+# timing maps straight from global-run RAW in one pass: only the HCAL unpacker and
+# the HBHE reconstruction run, the rechits go to MakeTimingMapsGlobal in memory and
+# nothing but the TFileService output is written (no DataRereco.root in between).
+# Same reconstruction settings as SubmitData/RECO_RAW2DIGI_RECO_DATA.py, on CRAB
+# with SubmitData/crabTiming.py.
+#   cmsRun ConfRAW_TimingMaps_cfg.py inputFiles=/store/data/.../RAW/...root nThreads=4
+
+from Configuration.StandardSequences.Eras import eras
+
+options = VarParsing.VarParsing('analysis')
+options.register('nThreads', 4, VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.int,
+                 "number of threads (and streams) for the job")
+options.register('globalTag', 'auto:run2_data', VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.string,
+                 "global tag for the HCAL conditions")
+options.register('rechitEnergy', 5.0, VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.float,
+                 "rechit energy above which the time goes into the maps")
+options.register('summaryOnly', True, VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.bool,
+                 "only the maps, robust time maps and timing summary, without the ~5k per-channel time histograms")
+options.register('skimFile', '', VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.string,
+                 "also write the rechits to TimingSkim files (one per stream) to redo the maps with other cuts")
+options.register('instrument', False, VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.bool,
+                 "write the time per stage and the hit counts of the module to <outputFile>_timing.json")
+options.maxEvents = -1
+options.outputFile = 'timingMaps.root'
+options.parseArguments()
+
+process = cms.Process('TIMING',eras.Run2_25ns)
+
+process.load('Configuration.StandardSequences.Services_cff')
+process.load('FWCore.MessageService.MessageLogger_cfi')
+process.load('Configuration.StandardSequences.GeometryRecoDB_cff')
+process.load('Configuration.StandardSequences.MagneticField_38T_PostLS1_cff')
+process.load('Configuration.StandardSequences.RawToDigi_cff')
+process.load('Configuration.StandardSequences.Reconstruction_cff')
+process.load('Configuration.StandardSequences.FrontierConditions_GlobalTag_condDBv2_cff')
+
+process.options = cms.untracked.PSet (
+    wantSummary = cms.untracked.bool(True),
+    numberOfThreads = cms.untracked.uint32(options.nThreads),
+    numberOfStreams = cms.untracked.uint32(options.nThreads),
+)
+
+process.maxEvents = cms.untracked.PSet( input = cms.untracked.int32(options.maxEvents) )
+process.MessageLogger.cerr.FwkReport.reportEvery = 10000
+
+inputFiles = options.inputFiles
+if not inputFiles:
+    # same HLTPhysics RAW as SubmitData/RECO_RAW2DIGI_RECO_DATA.py
+    inputFiles = ['root://cmsxrootd.fnal.gov//store/data/Run2016B/HLTPhysics3/RAW/v1/000/272/022/00000/6E3580B0-C70D-E611-9629-02163E014468.root']
+
+process.source = cms.Source("PoolSource",
+    fileNames = cms.untracked.vstring(*inputFiles)
+)
+
+from Configuration.AlCa.GlobalTag_condDBv2 import GlobalTag
+process.GlobalTag = GlobalTag(process.GlobalTag, options.globalTag, '')
+
+# Method 2 with a single pulse fit, as in the RECO script
+process.hbhereco = process.hbheprereco.clone()
+process.hbhereco.puCorrMethod = cms.int32(2)
+process.hbhereco.ts4chi2 = cms.double(99999.)
+process.hbhereco.timeMin = cms.double(-100.)
+process.hbhereco.timeMax = cms.double(100.)
+process.hbhereco.applyTimeConstraint = cms.bool(False)
+
+process.timingMaps = cms.EDAnalyzer('MakeTimingMapsGlobal')
+process.timingMaps.HBHERecHits = cms.untracked.string('hbhereco')
+process.timingMaps.rechitEnergy = cms.double(options.rechitEnergy)
+process.timingMaps.timeLowBound = cms.double(-12.5)
+process.timingMaps.timeHighBound = cms.double(12.5)
+# mergeTimingSummaries adds up the outputs of the jobs, drawTimingMapsBatch plots them
+process.timingMaps.channelHistograms = cms.bool(not options.summaryOnly)
+if options.skimFile:
+    process.timingMaps.skimFile = cms.untracked.string(options.skimFile)
+if options.instrument:
+    process.timingMaps.instrumentationFile = cms.untracked.string(options.outputFile.replace('.root', '') + '_timing.json')
+
+process.TFileService = cms.Service('TFileService', fileName = cms.string(options.outputFile) )
+
+# only the HCAL part of RawToDigi and of the local reconstruction, and no output module
+process.p = cms.Path(process.hcalDigis * process.hbhereco * process.timingMaps)
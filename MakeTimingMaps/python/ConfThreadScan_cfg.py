@@ -0,0 +1,56 @@
+import FWCore.ParameterSet.Config as cms
+import FWCore.ParameterSet.VarParsing as VarParsing
+# run either version of the timing maps module with a given number of threads,
+# used by scripts/threadScan.sh to compare the events/s of the two modules
+
+options = VarParsing.VarParsing('analysis')
+options.register('nThreads', 1, VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.int,
+                 "number of threads (and streams) for the job")
+options.register('module', 'global', VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.string,
+                 "'one' for MakeTimingMaps, 'global' for MakeTimingMapsGlobal")
+options.register('instrument', False, VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.bool,
+                 "write the time per stage and the hit counts of the module to <outputFile>_timing.json")
+options.register('timingFile', '', VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.string,
+                 "name of the instrument=True JSON, instead of <outputFile>_timing.json (which has the _numEvent tag of maxEvents)")
+options.maxEvents = -1
+options.outputFile = 'threadScan.root'
+options.parseArguments()
+
+process = cms.Process("Demo")
+
+process.load("FWCore.MessageService.MessageLogger_cfi")
+process.options = cms.untracked.PSet (
+    wantSummary = cms.untracked.bool(True),
+    numberOfThreads = cms.untracked.uint32(options.nThreads),
+    numberOfStreams = cms.untracked.uint32(options.nThreads),
+)
+
+process.maxEvents = cms.untracked.PSet( input = cms.untracked.int32(options.maxEvents) )
+process.MessageLogger.cerr.FwkReport.reportEvery = 10000
+
+inputFiles = options.inputFiles
+if not inputFiles:
+    # same 2016B HLTPhysics files as ConfFile_cfg.py
+    inputFiles = ["root://eoscms.cern.ch//store/user/sabrandt/HCAL_Timing_Study/run27276%dHLT%d.root" % (run, part)
+                  for run in (0, 1, 2) for part in range(4)]
+
+process.source = cms.Source("PoolSource",
+    fileNames = cms.untracked.vstring(*inputFiles)
+)
+
+if options.module == 'one':
+    process.timingMaps = cms.EDAnalyzer('MakeTimingMaps')
+else:
+    process.timingMaps = cms.EDAnalyzer('MakeTimingMapsGlobal')
+process.timingMaps.runNumber = cms.int32(273450)
+process.timingMaps.rechitEnergy = cms.double(5.0)
+process.timingMaps.timeLowBound = cms.double(-12.5)
+process.timingMaps.timeHighBound = cms.double(12.5)
+if options.instrument:
+    timingFile = options.timingFile or options.outputFile.replace('.root', '') + '_timing.json'
+    process.timingMaps.instrumentationFile = cms.untracked.string(timingFile)
+
+process.TFileService = cms.Service('TFileService', fileName = cms.string(options.outputFile) )
+
+
+process.p = cms.Path(process.timingMaps)
@@ -0,0 +1,39 @@
+import FWCore.ParameterSet.Config as cms
+from HBHETimingValidation.MakeTimingMaps.timingCorrelations_cff import channelGroup
+
+# Helpers for the 'spectrumWindows' and 'spectrumGroups' parameters of MakeTimingMaps /
+# MakeTimingMapsGlobal. Every group gets hCheckEnergy<window><group name> for every window.
+
+def spectrumWindow(name, low, high):
+    return cms.PSet(name = cms.string(name), low = cms.double(low), high = cms.double(high))
+
+# all channels without channels
+def spectrumGroup(name, channels=None, nBins=300, low=0., high=300.):
+    pset = cms.PSet(name = cms.string(name), nBins = cms.int32(nBins), low = cms.double(low), high = cms.double(high))
+    if channels is not None:
+        pset.channels = channels
+    return pset
+
+# what the modules do by default: hCheckEnergyIT/OOT1/OOT2 for all channels and
+# the ip51/ip54 variants for HB- ieta -15..-1
+defaultSpectrumWindows = cms.VPSet(
+    spectrumWindow('IT', -5., 5.),
+    spectrumWindow('OOT1', 6., 12.),
+    spectrumWindow('OOT2', 12., 20.),
+)
+
+defaultSpectrumGroups = cms.VPSet(
+    spectrumGroup('', nBins=500, low=0., high=1000.),
+    spectrumGroup('ip51', channelGroup(51, depth=[1, 2, 3], ietaLow=-15, ietaHigh=-1)),
+    spectrumGroup('ip54', channelGroup(54, depth=[1, 2, 3], ietaLow=-15, ietaHigh=-1)),
+)
+
+# one group per iphi slice on top of the defaults, e.g. suspect RBXs in HB-:
+#   process.timingMaps.spectrumGroups = phiSliceSpectra(range(49, 57), ietaLow=-16, ietaHigh=-1)
+# at most 64 groups in total
+def phiSliceSpectra(iphis, depth=[1, 2, 3], ietaLow=-16, ietaHigh=-1, nBins=300, low=0., high=300.):
+    groups = [g.clone() for g in defaultSpectrumGroups]
+    for iphi in iphis:
+        groups.append(spectrumGroup('ip%d_ieta%dto%d' % (iphi, ietaLow, ietaHigh),
+                                    channelGroup(iphi, depth, ietaLow, ietaHigh), nBins, low, high))
+    return cms.VPSet(*groups)
@@ -0,0 +1,33 @@
+import FWCore.ParameterSet.Config as cms
+
+# Helpers for the 'correlations' parameter of MakeTimingMaps / MakeTimingMapsGlobal.
+# Each entry correlates the hit times of two groups of channels in the same event
+# and gives hCorrTiming<name> (t_A vs t_B) and hCheckTiming<name> (t_A - t_B).
+
+def channelGroup(iphi, depth=[1], ietaLow=1, ietaHigh=16):
+    return cms.PSet(
+        depth = cms.vint32(depth),
+        ietaLow = cms.int32(ietaLow),
+        ietaHigh = cms.int32(ietaHigh),
+        iphi = cms.vint32(iphi if isinstance(iphi, list) else [iphi])
+    )
+
+def correlation(name, groupA, groupB):
+    return cms.PSet(name = cms.string(name), groupA = groupA, groupB = groupB)
+
+# what the modules do by default: iphi 67 with itself and 67 vs 66, depth 1 HB+
+defaultCorrelations = cms.VPSet(
+    correlation('Phi67Plus', channelGroup(67), channelGroup(67)),
+    correlation('66to67P', channelGroup(67), channelGroup(66)),
+)
+
+# every iphi slice against the next one, e.g.
+#   process.timingMaps.correlations = neighbourPhiCorrelations(depth=[1], ietaLow=-16, ietaHigh=-1)
+def neighbourPhiCorrelations(depth=[1], ietaLow=1, ietaHigh=16, step=1):
+    pairs = []
+    for iphi in range(1, 73, step):
+        other = (iphi + step - 1) % 72 + 1
+        pairs.append(correlation('Phi%dto%d_D%s_ieta%dto%d' % (iphi, other, ''.join(str(d) for d in depth), ietaLow, ietaHigh),
+                                 channelGroup(iphi, depth, ietaLow, ietaHigh),
+                                 channelGroup(other, depth, ietaLow, ietaHigh)))
+    return cms.VPSet(*pairs)
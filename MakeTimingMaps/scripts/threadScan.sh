@@ -0,0 +1,38 @@
+#! /bin/bash
+
+# Compare the throughput of MakeTimingMaps (one module, serialized) and
+# MakeTimingMapsGlobal (one accumulator per stream) for 1-16 threads.
+# usage: threadScan.sh [maxEvents] [inputFile ...]
+# For a fair comparison copy the input files to local disk first.
+# Every job also writes threadScan_<module>_<threads>_timing.json with the
+# time per stage of the module (see TimingInstrumentation.h).
+
+CFG=$CMSSW_BASE/src/HBHETimingValidation/MakeTimingMaps/python/ConfThreadScan_cfg.py
+NEVENTS=${1:-100000}
+shift
+INPUTS=""
+for f in "$@"; do INPUTS="$INPUTS inputFiles=$f"; done
+
+# The rate is that of the event loop, from the "event loop Real/event" line
+# of the TimeReport (wantSummary): config parsing, conditions and opening
+# the input are not counted, they would flatten the curve. Without that line
+# eventsPerSecond of the timing JSON is used (beginJob to endJob).
+printf "%-8s %8s %10s %10s\n" module threads loop[s] events/s
+for module in one global; do
+  for nt in 1 2 4 8 16; do
+    log=threadScan_${module}_${nt}.log
+    json=threadScan_${module}_${nt}_timing.json
+    # the JSON name is given explicitly, outputFile gets the _numEvent<N> tag of maxEvents
+    cmsRun $CFG module=$module nThreads=$nt maxEvents=$NEVENTS outputFile=threadScan_${module}_${nt}.root instrument=True timingFile=$json $INPUTS > $log 2>&1
+    # take the number of events actually processed from the job summary
+    nevt=$(grep -m1 "TrigReport Events total" $log | awk '{print $5}')
+    perEvent=$(grep -m1 "event loop Real/event" $log | awk '{print $NF}')
+    if [ -n "$perEvent" ]; then
+      # awk, the report can print the time in exponent notation
+      rate=$(awk -v t="$perEvent" 'BEGIN { if(t > 0) printf "%f", 1/t }')
+    else
+      rate=$(grep -m1 '"eventsPerSecond"' $json 2>/dev/null | tr -dc '0-9.')
+    fi
+    printf "%-8s %8d %10.1f %10.1f\n" $module $nt $(awk -v n="${nevt:-0}" -v r="${rate:-0}" 'BEGIN { printf "%f", (r > 0 ? n/r : 0) }') ${rate:-0}
+  done
+done
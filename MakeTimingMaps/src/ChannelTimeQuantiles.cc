@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "TDirectory.h"
+#include "TH2.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/ChannelTimeQuantiles.h"
+
+ChannelTimeQuantiles::ChannelTimeQuantiles(const Axis& axis, double truncatedFraction) :
+  axis_(axis),
+  truncatedFraction_(std::min(std::max(truncatedFraction, 0.0), 0.49)),
+  counts_(HBHEChannelMap::nChannels*(axis.nBins+2), 0)
+{}
+
+uint32_t ChannelTimeQuantiles::entries(int channel) const {
+  const uint32_t *c = &counts_[channel*(axis_.nBins+2)];
+  uint32_t n = 0;
+  for(int i = 0; i < axis_.nBins+2; ++i) n += c[i];
+  return n;
+}
+
+double ChannelTimeQuantiles::quantile(int channel, double q) const {
+  const uint32_t *c = &counts_[channel*(axis_.nBins+2)];
+  const double n = entries(channel);
+  if(n == 0) return 0.0;
+  const double width = (axis_.high-axis_.low)/axis_.nBins;
+  const double rank = std::min(std::max(q, 0.0), 1.0)*n;
+  double below = 0;
+  for(int bin = 0; bin < axis_.nBins+2; ++bin){
+    if(c[bin] == 0) continue;
+    if(below + c[bin] >= rank){
+      if(bin == 0) return axis_.low;
+      if(bin == axis_.nBins+1) return axis_.high;
+      return axis_.low + width*(bin-1 + (rank-below)/c[bin]);
+    }
+    below += c[bin];
+  }
+  return axis_.high;
+}
+
+double ChannelTimeQuantiles::truncatedMean(int channel) const {
+  const uint32_t *c = &counts_[channel*(axis_.nBins+2)];
+  const double n = entries(channel);
+  if(n == 0) return 0.0;
+  const double width = (axis_.high-axis_.low)/axis_.nBins;
+  // hits with ranks in [first, last] are kept; the hits of a bin are taken to be
+  // spread evenly over it, the flows to sit at the edges of the range
+  const double first = truncatedFraction_*n, last = (1.0-truncatedFraction_)*n;
+  double below = 0, sumw = 0, sumwt = 0;
+  for(int bin = 0; bin < axis_.nBins+2 && below < last; ++bin){
+    if(c[bin] == 0) continue;
+    const double from = std::max(below, first), to = std::min(below + c[bin], last);
+    if(to > from){
+      double t;
+      if(bin == 0) t = axis_.low;
+      else if(bin == axis_.nBins+1) t = axis_.high;
+      else t = axis_.low + width*(bin-1 + 0.5*(from+to-2*below)/c[bin]);
+      sumw += to-from;
+      sumwt += (to-from)*t;
+    }
+    below += c[bin];
+  }
+  return sumw > 0 ? sumwt/sumw : 0.0;
+}
+
+void ChannelTimeQuantiles::merge(const ChannelTimeQuantiles& other) {
+  // an empty sketch takes the axis of the other, as in read()
+  bool empty = std::find_if(counts_.begin(), counts_.end(), [](uint32_t c) { return c != 0; }) == counts_.end();
+  if(empty){
+    axis_ = other.axis_;
+    counts_ = other.counts_;
+    return;
+  }
+  if(other.axis_.nBins != axis_.nBins || other.axis_.low != axis_.low || other.axis_.high != axis_.high){
+    throw std::runtime_error("ChannelTimeQuantiles: cannot merge sketches with different time axes");
+  }
+  for(unsigned int i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+}
+
+void ChannelTimeQuantiles::write(TDirectory* dir) const {
+  const int nChannels = HBHEChannelMap::nChannels;
+  TH2F *hMedian[3], *hIQR[3], *hTruncMean[3], *hUnderflow[3], *hOverflow[3];
+  for(int d = 0; d < 3; ++d){
+    std::string depth = std::to_string(d+1);
+    hMedian[d] = new TH2F(("hTimeMedian_Depth"+depth).c_str(),("Median time, Depth "+depth).c_str(),59,-29.5,29.5,72,0.5,72.5);
+    hIQR[d] = new TH2F(("hTimeIQR_Depth"+depth).c_str(),("Time interquartile range, Depth "+depth).c_str(),59,-29.5,29.5,72,0.5,72.5);
+    hTruncMean[d] = new TH2F(("hTimeTruncMean_Depth"+depth).c_str(),("Truncated mean time, Depth "+depth).c_str(),59,-29.5,29.5,72,0.5,72.5);
+    hUnderflow[d] = new TH2F(("hTimeUnderflow_Depth"+depth).c_str(),("Fraction of hits below the quantile range, Depth "+depth).c_str(),59,-29.5,29.5,72,0.5,72.5);
+    hOverflow[d] = new TH2F(("hTimeOverflow_Depth"+depth).c_str(),("Fraction of hits above the quantile range, Depth "+depth).c_str(),59,-29.5,29.5,72,0.5,72.5);
+  }
+  TH2I *sketch = new TH2I("hTimeQuantileSketch","hit times per channel;HBHEChannelMap channel;time [ns]",
+                          nChannels,-0.5,nChannels-0.5,axis_.nBins,axis_.low,axis_.high);
+
+  double total = 0;
+  for(int ch = 0; ch < nChannels; ++ch){
+    const uint32_t *c = &counts_[ch*(axis_.nBins+2)];
+    const double n = entries(ch);
+    if(n == 0) continue;
+    for(int bin = 0; bin < axis_.nBins+2; ++bin) if(c[bin]) sketch->SetBinContent(sketch->GetBin(ch+1, bin), c[bin]);
+    total += n;
+
+    const HBHEChannelMap::Channel& channel = HBHEChannelMap::channel(ch);
+    const int d = channel.depth-1;
+    const int bin = hMedian[d]->GetBin(channel.ieta+30, channel.iphi);
+    hMedian[d]->SetBinContent(bin, median(ch));
+    hIQR[d]->SetBinContent(bin, iqr(ch));
+    hTruncMean[d]->SetBinContent(bin, truncatedMean(ch));
+    hUnderflow[d]->SetBinContent(bin, c[0]/n);
+    hOverflow[d]->SetBinContent(bin, c[axis_.nBins+1]/n);
+  }
+  sketch->SetEntries(total);
+
+  for(int d = 0; d < 3; ++d){
+    hMedian[d]->SetDirectory(dir);
+    hIQR[d]->SetDirectory(dir);
+    hTruncMean[d]->SetDirectory(dir);
+    hUnderflow[d]->SetDirectory(dir);
+    hOverflow[d]->SetDirectory(dir);
+  }
+  sketch->SetDirectory(dir);
+}
+
+bool ChannelTimeQuantiles::read(TDirectory* dir) {
+  TH2 *sketch = (TH2*)dir->Get("hTimeQuantileSketch");
+  if(!sketch) return false;
+
+  Axis axis;
+  axis.nBins = sketch->GetNbinsY();
+  axis.low = sketch->GetYaxis()->GetXmin();
+  axis.high = sketch->GetYaxis()->GetXmax();
+  if(sketch->GetNbinsX() != HBHEChannelMap::nChannels){
+    throw std::runtime_error("ChannelTimeQuantiles: hTimeQuantileSketch does not have one bin per HBHEChannelMap channel");
+  }
+  bool empty = std::find_if(counts_.begin(), counts_.end(), [](uint32_t c) { return c != 0; }) == counts_.end();
+  if(empty){
+    axis_ = axis;
+    counts_.assign(HBHEChannelMap::nChannels*(axis_.nBins+2), 0);
+  }
+  else if(axis.nBins != axis_.nBins || std::abs(axis.low-axis_.low) > 1e-9 || std::abs(axis.high-axis_.high) > 1e-9){
+    throw std::runtime_error("ChannelTimeQuantiles: cannot merge sketches with different time axes");
+  }
+
+  for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+    uint32_t *c = &counts_[ch*(axis_.nBins+2)];
+    for(int bin = 0; bin < axis_.nBins+2; ++bin) c[bin] += uint32_t(sketch->GetBinContent(sketch->GetBin(ch+1, bin)) + 0.5);
+  }
+  delete sketch;
+  return true;
+}
@@ -0,0 +1,70 @@
+#include <stdexcept>
+#include <string>
+#include <sstream>
+
+#include "TH1.h"
+#include "TDirectory.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/ChannelTimingStore.h"
+
+namespace {
+  std::string int2string(int i) {
+    std::stringstream ss;
+    ss << i;
+    return ss.str();
+  }
+}
+
+ChannelTimingStore::ChannelTimingStore() :
+  bins_(nChannels*(nBins+2), 0),
+  stats_(3*nChannels, 0.0)
+{}
+
+uint32_t ChannelTimingStore::entries(int channel) const {
+  const uint32_t *b = bins(channel);
+  uint32_t n = 0;
+  for(int i = 0; i < nBins+2; ++i) n += b[i];
+  return n;
+}
+
+void ChannelTimingStore::merge(const ChannelTimingStore& other) {
+  for(unsigned int i = 0; i < bins_.size(); ++i) bins_[i] += other.bins_[i];
+  for(unsigned int i = 0; i < stats_.size(); ++i) stats_[i] += other.stats_[i];
+}
+
+void ChannelTimingStore::add(int channel, const TH1& h) {
+  const TAxis *axis = h.GetXaxis();
+  if(axis->GetNbins() != nBins || axis->GetXmin() != timeMin || axis->GetXmax() != timeMax){
+    throw std::runtime_error(std::string("ChannelTimingStore: ")+h.GetName()+" does not have the binning of the channel histograms");
+  }
+  uint32_t *b = &bins_[channel*(nBins+2)];
+  for(int i = 0; i < nBins+2; ++i) b[i] += uint32_t(h.GetBinContent(i) + 0.5);
+  // sum of weights, of weights squared, of wt and of wt^2
+  double stats[4];
+  h.GetStats(stats);
+  double *s = &stats_[3*channel];
+  s[0] += stats[0];
+  s[1] += stats[2];
+  s[2] += stats[3];
+}
+
+void ChannelTimingStore::write(TDirectory* dir) const {
+  for(int ch = 0; ch < nChannels; ++ch){
+    uint32_t n = entries(ch);
+    if(n == 0) continue;
+
+    int ieta, iphi, depth;
+    HBHEChannelMap::channelCoordinates(ch, ieta, iphi, depth);
+    std::string name = "Depth"+int2string(depth)+"_ieta"+int2string(ieta)+"_iphi"+int2string(iphi);
+    TH1F *h = new TH1F(name.c_str(),name.c_str(),nBins,timeMin,timeMax);
+
+    const uint32_t *b = bins(ch);
+    for(int i = 0; i < nBins+2; ++i) if(b[i]) h->SetBinContent(i, b[i]);
+    // unit weights, so the sum of weights squared is the sum of weights
+    const double *s = &stats_[3*ch];
+    double stats[4] = {s[0], s[0], s[1], s[2]};
+    h->PutStats(stats);
+    h->SetEntries(n);
+    h->SetDirectory(dir);
+  }
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "TArrayD.h"
+#include "TDirectory.h"
+#include "TH2.h"
+#include "TProfile2D.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/DepthTimingMaps.h"
+
+DepthTimingMaps::DepthTimingMaps(double timeLow, double timeHigh) :
+  timeLow_(timeLow),
+  timeHigh_(timeHigh),
+  hasRange_(timeLow != timeHigh),
+  occupancy_(HBHEChannelMap::nChannels, 0.0),
+  profN_(HBHEChannelMap::nChannels, 0.0),
+  profSum_(HBHEChannelMap::nChannels, 0.0),
+  profSum2_(HBHEChannelMap::nChannels, 0.0)
+{}
+
+void DepthTimingMaps::merge(const DepthTimingMaps& other) {
+  // an empty map takes the time range of the other, as in read()
+  if(std::find_if(occupancy_.begin(), occupancy_.end(), [](double n) { return n != 0; }) == occupancy_.end()){
+    timeLow_ = other.timeLow_;
+    timeHigh_ = other.timeHigh_;
+    hasRange_ = other.hasRange_;
+  }
+  for(int i = 0; i < HBHEChannelMap::nChannels; ++i){
+    occupancy_[i] += other.occupancy_[i];
+    profN_[i] += other.profN_[i];
+    profSum_[i] += other.profSum_[i];
+    profSum2_[i] += other.profSum2_[i];
+  }
+}
+
+void DepthTimingMaps::write(TDirectory* dir) const {
+  TProfile2D *prof[3];
+  TH2F *occ[3];
+  // statistics as TH1 keeps them while filling: sum of w, w^2, wx, wx^2, wy, wy^2, wxy (, wz, wz^2)
+  double profStats[3][9] = {{0}};
+  double occStats[3][7] = {{0}};
+  for(int d = 0; d < 3; ++d){
+    std::string depth = std::to_string(d+1);
+    prof[d] = new TProfile2D(("hHBHETiming_Depth"+depth).c_str(),("hHBHETiming_Depth"+depth).c_str(),59,-29.5,29.5,72,0.5,72.5, timeLow_, timeHigh_,"s");
+    occ[d] = new TH2F(("occupancy_d"+depth).c_str(),("occupancy_depth"+depth).c_str(),59,-29.5,29.5,72,0.5,72.5);
+  }
+
+  for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+    const HBHEChannelMap::Channel& c = HBHEChannelMap::channel(ch);
+    const int d = c.depth-1;
+    const double ieta = c.ieta, iphi = c.iphi;
+    const int bin = prof[d]->GetBin(c.ieta+30, c.iphi);
+
+    double occupancy = occupancy_[ch];
+    if(occupancy > 0){
+      double *s = occStats[d];
+      occ[d]->SetBinContent(bin, occupancy);
+      s[0] += occupancy;
+      s[1] += occupancy;
+      s[2] += occupancy*ieta;
+      s[3] += occupancy*ieta*ieta;
+      s[4] += occupancy*iphi;
+      s[5] += occupancy*iphi*iphi;
+      s[6] += occupancy*ieta*iphi;
+    }
+
+    double n = profN_[ch];
+    if(n > 0){
+      double *s = profStats[d];
+      // a profile bin holds the sum of the values, their squares and the number of entries
+      prof[d]->SetBinEntries(bin, n);
+      prof[d]->SetBinContent(bin, profSum_[ch]);
+      prof[d]->GetSumw2()->SetAt(profSum2_[ch], bin);
+      s[0] += n;
+      s[1] += n;
+      s[2] += n*ieta;
+      s[3] += n*ieta*ieta;
+      s[4] += n*iphi;
+      s[5] += n*iphi*iphi;
+      s[6] += n*ieta*iphi;
+      s[7] += profSum_[ch];
+      s[8] += profSum2_[ch];
+    }
+  }
+
+  for(int d = 0; d < 3; ++d){
+    prof[d]->PutStats(profStats[d]);
+    prof[d]->SetEntries(profStats[d][0]);
+    occ[d]->PutStats(occStats[d]);
+    occ[d]->SetEntries(occStats[d][0]);
+
+    prof[d]->SetDirectory(dir);
+    occ[d]->SetDirectory(dir);
+  }
+}
+
+bool DepthTimingMaps::read(TDirectory* dir) {
+  // what Get() reads from a file belongs to the caller
+  std::unique_ptr<TProfile2D> prof[3];
+  std::unique_ptr<TH2> occ[3];
+  for(int d = 0; d < 3; ++d){
+    std::string depth = std::to_string(d+1);
+    prof[d].reset((TProfile2D*)dir->Get(("hHBHETiming_Depth"+depth).c_str()));
+    occ[d].reset((TH2*)dir->Get(("occupancy_d"+depth).c_str()));
+  }
+  for(int d = 0; d < 3; ++d) if(!prof[d] || !occ[d]) return false;
+
+  const double low = prof[0]->GetZmin(), high = prof[0]->GetZmax();
+  bool empty = std::find_if(occupancy_.begin(), occupancy_.end(), [](double n) { return n != 0; }) == occupancy_.end();
+  if(empty){
+    timeLow_ = low;
+    timeHigh_ = high;
+    hasRange_ = low != high;
+  }
+  else if(std::abs(low-timeLow_) > 1e-9 || std::abs(high-timeHigh_) > 1e-9){
+    throw std::runtime_error("DepthTimingMaps: cannot merge maps with different time ranges");
+  }
+
+  for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+    const HBHEChannelMap::Channel& c = HBHEChannelMap::channel(ch);
+    const int d = c.depth-1;
+    const int bin = prof[d]->GetBin(c.ieta+30, c.iphi);
+    // the bin content of a profile is the sum of the values, see write()
+    const TArrayD& sums = *prof[d];
+    occupancy_[ch] += occ[d]->GetBinContent(bin);
+    profN_[ch] += prof[d]->GetBinEntries(bin);
+    profSum_[ch] += sums.At(bin);
+    profSum2_[ch] += prof[d]->GetSumw2()->At(bin);
+  }
+  return true;
+}
@@ -0,0 +1,97 @@
+#include <stdexcept>
+
+#include "TDirectory.h"
+#include "TH1.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/EnergySpectra.h"
+
+std::vector<EnergySpectra::Window> EnergySpectra::defaultWindows() {
+  std::vector<Window> windows;
+  windows.push_back({"IT", -5, 5});
+  windows.push_back({"OOT1", 6, 12});
+  windows.push_back({"OOT2", 12, 20});
+  return windows;
+}
+
+std::vector<EnergySpectra::Group> EnergySpectra::defaultGroups() {
+  std::vector<Group> groups;
+  groups.push_back({"", true, TimingCorrelations::Group(), 500, 0, 1000});
+  groups.push_back({"ip51", false, {{1, 2, 3}, -15, -1, {51}}, 300, 0, 300});
+  groups.push_back({"ip54", false, {{1, 2, 3}, -15, -1, {54}}, 300, 0, 300});
+  return groups;
+}
+
+EnergySpectra::EnergySpectra(const std::vector<Group>& groups, const std::vector<Window>& windows) :
+  groups_(groups),
+  windows_(windows),
+  allChannelGroups_(0),
+  selectedGroups_(HBHEChannelMap::nChannels, 0)
+{
+  if(groups_.size() > maxGroups) throw std::runtime_error("EnergySpectra: more than 64 channel groups");
+  if(windows_.size() > maxWindows) throw std::runtime_error("EnergySpectra: more than 32 time windows");
+
+  for(unsigned int g = 0; g < groups_.size(); ++g){
+    const Group& group = groups_[g];
+    const uint64_t bit = uint64_t(1) << g;
+    if(group.allChannels) allChannelGroups_ |= bit;
+    else for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+      int ieta, iphi, depth;
+      HBHEChannelMap::channelCoordinates(ch, ieta, iphi, depth);
+      if(group.channels.contains(ieta, iphi, depth)) selectedGroups_[ch] |= bit;
+    }
+    for(unsigned int w = 0; w < windows_.size(); ++w) spectra_.push_back(FixedHistogram(group.nBins, group.low, group.high));
+  }
+}
+
+void EnergySpectra::windowMasks(unsigned int n, const float* time, uint32_t* masks) const {
+  for(unsigned int i = 0; i < n; ++i) masks[i] = 0;
+  // compared in double like windowMask()
+  for(unsigned int w = 0; w < windows_.size(); ++w){
+    const double low = windows_[w].low, high = windows_[w].high;
+    for(unsigned int i = 0; i < n; ++i){
+      const double t = time[i];
+      masks[i] |= uint32_t((t > low) & (t < high)) << w;
+    }
+  }
+}
+
+void EnergySpectra::fill(unsigned int n, const int* channel, const float* energy, const uint32_t* masks) {
+  index_.resize(n);
+  uint32_t *index = index_.data();
+  const unsigned int nWindows = windows_.size();
+  for(unsigned int w = 0; w < nWindows; ++w){
+    // the hits in window w, without branches: every hit is written but only
+    // kept if its bit is set
+    unsigned int nIn = 0;
+    for(unsigned int i = 0; i < n; ++i){
+      index[nIn] = i;
+      nIn += (masks[i] >> w) & 1;
+    }
+
+    for(uint64_t groups = allChannelGroups_; groups; groups &= groups-1){
+      FixedHistogram& h = spectra_[__builtin_ctzll(groups)*nWindows + w];
+      for(unsigned int k = 0; k < nIn; ++k) h.fill(energy[index[k]]);
+    }
+
+    for(unsigned int k = 0; k < nIn; ++k){
+      const uint32_t i = index[k];
+      // one lookup per hit in the window, plus a fill per selected group of its channel
+      uint64_t groups = channel[i] >= 0 ? selectedGroups_[channel[i]] : 0;
+      for(; groups; groups &= groups-1) spectra_[__builtin_ctzll(groups)*nWindows + w].fill(energy[i]);
+    }
+  }
+}
+
+void EnergySpectra::merge(const EnergySpectra& other) {
+  for(unsigned int i = 0; i < spectra_.size(); ++i) spectra_[i].merge(other.spectra_[i]);
+}
+
+void EnergySpectra::write(TDirectory* dir) const {
+  for(unsigned int g = 0; g < groups_.size(); ++g){
+    for(unsigned int w = 0; w < windows_.size(); ++w){
+      std::string name = "hCheckEnergy"+windows_[w].name+groups_[g].name;
+      TH1 *h = spectra_[g*windows_.size()+w].makeTH1F(name.c_str(), name.c_str());
+      h->SetDirectory(dir);
+    }
+  }
+}
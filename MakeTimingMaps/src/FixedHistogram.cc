@@ -0,0 +1,74 @@
+#include "TH1.h"
+#include "TH2.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/FixedHistogram.h"
+
+FixedHistogram::FixedHistogram(int nBins, double xMin, double xMax) :
+  nBins_(nBins),
+  xMin_(xMin),
+  xMax_(xMax),
+  counts_(nBins+2, 0.0),
+  entries_(0),
+  sumw_(0),
+  sumw2_(0),
+  sumwx_(0),
+  sumwx2_(0)
+{}
+
+void FixedHistogram::merge(const FixedHistogram& other) {
+  for(unsigned int i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+  entries_ += other.entries_;
+  sumw_ += other.sumw_;
+  sumw2_ += other.sumw2_;
+  sumwx_ += other.sumwx_;
+  sumwx2_ += other.sumwx2_;
+}
+
+TH1F* FixedHistogram::makeTH1F(const char* name, const char* title) const {
+  TH1F *h = new TH1F(name, title, nBins_, xMin_, xMax_);
+  for(int i = 0; i < nBins_+2; ++i) if(counts_[i] != 0) h->SetBinContent(i, counts_[i]);
+  double stats[4] = {sumw_, sumw2_, sumwx_, sumwx2_};
+  h->PutStats(stats);
+  h->SetEntries(entries_);
+  return h;
+}
+
+FixedHistogram2D::FixedHistogram2D(int nBinsX, double xMin, double xMax, int nBinsY, double yMin, double yMax) :
+  x_(nBinsX, xMin, xMax),
+  y_(nBinsY, yMin, yMax),
+  counts_((nBinsX+2)*(nBinsY+2), 0.0),
+  entries_(0),
+  sumw_(0),
+  sumw2_(0),
+  sumwx_(0),
+  sumwx2_(0),
+  sumwy_(0),
+  sumwy2_(0),
+  sumwxy_(0)
+{}
+
+void FixedHistogram2D::merge(const FixedHistogram2D& other) {
+  for(unsigned int i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+  entries_ += other.entries_;
+  sumw_ += other.sumw_;
+  sumw2_ += other.sumw2_;
+  sumwx_ += other.sumwx_;
+  sumwx2_ += other.sumwx2_;
+  sumwy_ += other.sumwy_;
+  sumwy2_ += other.sumwy2_;
+  sumwxy_ += other.sumwxy_;
+}
+
+TH2F* FixedHistogram2D::makeTH2F(const char* name, const char* title) const {
+  TH2F *h = new TH2F(name, title, x_.nBins(), x_.xMin(), x_.xMax(), y_.nBins(), y_.xMin(), y_.xMax());
+  for(int by = 0; by < y_.nBins()+2; ++by){
+    for(int bx = 0; bx < x_.nBins()+2; ++bx){
+      double c = counts_[by*(x_.nBins()+2) + bx];
+      if(c != 0) h->SetBinContent(h->GetBin(bx, by), c);
+    }
+  }
+  double stats[7] = {sumw_, sumw2_, sumwx_, sumwx2_, sumwy_, sumwy2_, sumwxy_};
+  h->PutStats(stats);
+  h->SetEntries(entries_);
+  return h;
+}
@@ -0,0 +1,92 @@
+#include <cstdio>
+#include <set>
+#include <stdexcept>
+
+#include "TDirectory.h"
+#include "TH1.h"
+#include "TKey.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/MergedTimingMaps.h"
+
+namespace {
+  bool startsWith(const std::string& name, const char* prefix) {
+    return name.compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+  }
+}
+
+MergedTimingMaps::MergedTimingMaps() :
+  inputs_(0),
+  // the time range is taken from the first maps read
+  maps_(0, 0),
+  sketches_(0)
+{}
+
+MergedTimingMaps::~MergedTimingMaps() {}
+
+void MergedTimingMaps::addHistogram(const TH1& h) {
+  std::unique_ptr<TH1>& sum = histograms_[h.GetName()];
+  if(!sum){
+    sum.reset((TH1*)h.Clone());
+    sum->SetDirectory(nullptr);
+  }
+  else if(!sum->Add(&h)){
+    throw std::runtime_error(std::string("MergedTimingMaps: cannot add histograms ")+h.GetName()+" with different binnings");
+  }
+}
+
+bool MergedTimingMaps::add(TDirectory* dir) {
+  if(!maps_.read(dir)) return false;
+  ++inputs_;
+  if(quantiles_.read(dir)) ++sketches_;
+  summary_.read(dir);
+
+  // one pass over the keys for the per-channel histograms and the rest
+  std::set<std::string> seen;
+  TIter nextKey(dir->GetListOfKeys());
+  TKey *key;
+  while((key = (TKey*)nextKey())){
+    std::string name = key->GetName();
+    // keys are listed highest cycle first, older cycles are skipped
+    if(!seen.insert(name).second) continue;
+
+    int depth, ieta, iphi;
+    if(sscanf(name.c_str(), "Depth%d_ieta%d_iphi%d", &depth, &ieta, &iphi) == 3){
+      int ch = HBHEChannelMap::channelIndex(ieta, iphi, depth);
+      if(ch < 0) continue;
+      std::unique_ptr<TH1> h((TH1*)key->ReadObj());
+      if(!h) continue;
+      if(!channelTimes_) channelTimes_.reset(new ChannelTimingStore());
+      channelTimes_->add(ch, *h);
+    }
+    else if(startsWith(name, "hCheckTiming") || startsWith(name, "hCorrTiming") || startsWith(name, "hCheckEnergy")){
+      std::unique_ptr<TObject> object(key->ReadObj());
+      const TH1 *h = dynamic_cast<const TH1*>(object.get());
+      if(h) addHistogram(*h);
+    }
+  }
+  return true;
+}
+
+void MergedTimingMaps::merge(const MergedTimingMaps& other) {
+  inputs_ += other.inputs_;
+  maps_.merge(other.maps_);
+  if(other.channelTimes_){
+    if(!channelTimes_) channelTimes_.reset(new ChannelTimingStore());
+    channelTimes_->merge(*other.channelTimes_);
+  }
+  quantiles_.merge(other.quantiles_);
+  sketches_ += other.sketches_;
+  summary_.merge(other.summary_);
+  for(auto const& h : other.histograms_) addHistogram(*h.second);
+}
+
+void MergedTimingMaps::write(TDirectory* dir) const {
+  maps_.write(dir);
+  if(sketches_ > 0) quantiles_.write(dir);
+  if(!summary_.sections().empty()) summary_.write(dir);
+  for(auto const& h : histograms_){
+    TH1 *copy = (TH1*)h.second->Clone();
+    copy->SetDirectory(dir);
+  }
+  if(channelTimes_) channelTimes_->write(dir);
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "TDirectory.h"
+#include "TH1.h"
+#include "TTree.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/PulseShapeCapture.h"
+
+PulseShapeCapture::PulseShapeCapture(const Config& config) :
+  config_(config),
+  timeTrigger_(config.timeLow < config.timeHigh),
+  anyChannels_(false),
+  selected_(HBHEChannelMap::nChannels, 0),
+  sum_(HBHEChannelMap::nChannels*nSamples, 0.0),
+  sum2_(HBHEChannelMap::nChannels*nSamples, 0.0),
+  count_(HBHEChannelMap::nChannels, 0),
+  next_(0),
+  nCaptured_(0),
+  run_(0),
+  lumi_(0),
+  event_(0)
+{
+  for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+    int ieta, iphi, depth;
+    HBHEChannelMap::channelCoordinates(ch, ieta, iphi, depth);
+    for(const TimingCorrelations::Group& group : config_.channels){
+      if(group.contains(ieta, iphi, depth)) selected_[ch] = 1;
+    }
+    if(selected_[ch]) anyChannels_ = true;
+  }
+  ring_.reserve(config_.maxCaptures);
+}
+
+void PulseShapeCapture::capture(int channel, double energy, double time, uint32_t auxHBHE, uint32_t aux) {
+  Capture c;
+  c.run = run_;
+  c.lumi = lumi_;
+  c.event = event_;
+  c.channel = channel;
+  c.energy = energy;
+  c.time = time;
+  unpack(auxHBHE, aux, c.adc);
+
+  double *sum = &sum_[channel*nSamples];
+  double *sum2 = &sum2_[channel*nSamples];
+  for(int i = 0; i < nSamples; ++i){
+    sum[i] += c.adc[i];
+    sum2[i] += c.adc[i]*c.adc[i];
+  }
+  ++count_[channel];
+  ++nCaptured_;
+
+  if(config_.maxCaptures == 0) return;
+  if(ring_.size() < config_.maxCaptures) ring_.push_back(c);
+  else {
+    ring_[next_] = c;
+    if(++next_ == ring_.size()) next_ = 0;
+  }
+}
+
+std::vector<PulseShapeCapture::Capture> PulseShapeCapture::captures() const {
+  // next_ is the oldest once the ring is full and 0 before
+  std::vector<Capture> ordered(ring_.begin()+next_, ring_.end());
+  ordered.insert(ordered.end(), ring_.begin(), ring_.begin()+next_);
+  return ordered;
+}
+
+void PulseShapeCapture::merge(const PulseShapeCapture& other) {
+  for(unsigned int i = 0; i < sum_.size(); ++i){
+    sum_[i] += other.sum_[i];
+    sum2_[i] += other.sum2_[i];
+  }
+  for(unsigned int i = 0; i < count_.size(); ++i) count_[i] += other.count_[i];
+  nCaptured_ += other.nCaptured_;
+
+  std::vector<Capture> all = captures();
+  std::vector<Capture> more = other.captures();
+  all.insert(all.end(), more.begin(), more.end());
+  std::stable_sort(all.begin(), all.end(), [](const Capture& a, const Capture& b) {
+    if(a.run != b.run) return a.run < b.run;
+    if(a.lumi != b.lumi) return a.lumi < b.lumi;
+    return a.event < b.event;
+  });
+  if(all.size() > config_.maxCaptures) all.erase(all.begin(), all.end()-config_.maxCaptures);
+  ring_.swap(all);
+  ring_.reserve(config_.maxCaptures);
+  // oldest first again, so a full ring continues at the start
+  next_ = 0;
+}
+
+void PulseShapeCapture::write(TDirectory* dir) const {
+  TDirectory *old = gDirectory;
+
+  // average shape of every channel with captures, the error is that of the mean
+  TDirectory *shapeDir = dir->mkdir("pulseShapes");
+  for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+    const double n = count_[ch];
+    if(n == 0) continue;
+    int ieta, iphi, depth;
+    HBHEChannelMap::channelCoordinates(ch, ieta, iphi, depth);
+    std::string name = "PulseShape_Depth"+std::to_string(depth)+"_ieta"+std::to_string(ieta)+"_iphi"+std::to_string(iphi);
+    TH1F *h = new TH1F(name.c_str(),(name+";time slice;average ADC").c_str(),nSamples,-0.5,nSamples-0.5);
+    const double *sum = &sum_[ch*nSamples];
+    const double *sum2 = &sum2_[ch*nSamples];
+    for(int i = 0; i < nSamples; ++i){
+      double mean = sum[i]/n;
+      double var = sum2[i]/n - mean*mean;
+      h->SetBinContent(i+1, mean);
+      h->SetBinError(i+1, var > 0 ? std::sqrt(var/n) : 0.0);
+    }
+    h->SetEntries(n);
+    h->SetDirectory(shapeDir);
+  }
+
+  dir->cd();
+  UInt_t run, lumi;
+  ULong64_t event;
+  Int_t depth, ieta, iphi;
+  Float_t energy, time;
+  UChar_t adc[nSamples];
+  std::string title = "ADC samples of the last "+std::to_string(ring_.size())+" of "+std::to_string(nCaptured_)+" captured rechits";
+  TTree *tree = new TTree("pulseCaptures", title.c_str());
+  tree->Branch("run", &run, "run/i");
+  tree->Branch("lumi", &lumi, "lumi/i");
+  tree->Branch("event", &event, "event/l");
+  tree->Branch("depth", &depth, "depth/I");
+  tree->Branch("ieta", &ieta, "ieta/I");
+  tree->Branch("iphi", &iphi, "iphi/I");
+  tree->Branch("energy", &energy, "energy/F");
+  tree->Branch("time", &time, "time/F");
+  tree->Branch("adc", adc, ("adc["+std::to_string(nSamples)+"]/b").c_str());
+  for(const Capture& c : captures()){
+    run = c.run;
+    lumi = c.lumi;
+    event = c.event;
+    HBHEChannelMap::channelCoordinates(c.channel, ieta, iphi, depth);
+    energy = c.energy;
+    time = c.time;
+    std::copy(c.adc, c.adc+nSamples, adc);
+    tree->Fill();
+  }
+
+  old->cd();
+}
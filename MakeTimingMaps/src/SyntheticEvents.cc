@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <cmath>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/SyntheticEvents.h"
+
+namespace {
+  // fraction of the charge per time slice of a pulse starting in slice 3
+  const double pulseShape[4] = {0.05, 0.60, 0.30, 0.05};
+  const double adcPerGeV = 0.5;
+  const double pedestal = 3.0;
+}
+
+SyntheticEventGenerator::SyntheticEventGenerator(const Config& config) :
+  config_(config),
+  rng_(config.seed),
+  offsets_(HBHEChannelMap::nChannels)
+{
+  std::normal_distribution<float> offset(0.0, config_.offsetSpread);
+  for(float& o : offsets_) o = offset(rng_);
+}
+
+void SyntheticEventGenerator::next(std::vector<SyntheticHit>& hits) {
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::exponential_distribution<double> noise(1.0/config_.noiseEnergy);
+  std::exponential_distribution<double> signal(1.0/config_.signalEnergy);
+  std::normal_distribution<double> resolution(0.0, config_.timeResolution);
+  std::uniform_real_distribution<double> outOfTime(config_.ootLow, config_.ootHigh);
+
+  hits.clear();
+  for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+    if(!(uniform(rng_) < config_.occupancy)) continue;
+    SyntheticHit hit;
+    HBHEChannelMap::channelCoordinates(ch, hit.ieta, hit.iphi, hit.depth);
+    hit.energy = uniform(rng_) < config_.signalFraction ? signal(rng_) : noise(rng_);
+    hit.time = uniform(rng_) < config_.ootFraction ? outOfTime(rng_) : offsets_[ch] + resolution(rng_);
+
+    // the pulse moves by one time slice per 25 ns
+    const int shift = (int)std::floor(hit.time/25.0 + 0.5);
+    uint64_t words = 0;
+    for(int ts = 0; ts < 8; ++ts){
+      const int k = ts - 3 - shift;
+      double adc = pedestal + (k >= 0 && k < 4 ? adcPerGeV*hit.energy*pulseShape[k] : 0.0);
+      words |= uint64_t(std::min(127, (int)adc)) << 7*ts;
+    }
+    hit.auxHBHE = words & 0xFFFFFFF;
+    hit.aux = (words >> 28) & 0xFFFFFFF;
+    hits.push_back(hit);
+  }
+}
@@ -0,0 +1,130 @@
+#include "TDirectory.h"
+#include "TH1.h"
+#include "TH2.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingAccumulator.h"
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingInstrumentation.h"
+
+TimingAccumulator::TimingAccumulator(const Config& config) :
+  config_(config),
+  maps_(config.timeLow, config.timeHigh),
+  channelTimes_(config.channelHistograms ? new ChannelTimingStore() : nullptr),
+  quantiles_(config.quantileAxis, config.truncatedFraction),
+  lumiMoments_(nullptr),
+  counters_(nullptr),
+  correlations_(config.correlationAxis, config.correlations),
+  spectra_(config.spectrumGroups, config.spectrumWindows)
+{}
+
+void TimingAccumulator::setCounters(TimingHitCounters* counters) {
+  counters_ = counters;
+  if(!counters_) return;
+  counters_->windowNames.clear();
+  for(const EnergySpectra::Window& w : spectra_.windows()) counters_->windowNames.push_back(w.name);
+  counters_->windowHits.resize(counters_->windowNames.size(), 0);
+}
+
+void TimingAccumulator::countWindows(uint32_t windows) {
+  for(; windows; windows &= windows-1) ++counters_->windowHits[__builtin_ctz(windows)];
+}
+
+void TimingAccumulator::fillTiming(int channel, double time) {
+  // hits of channels which do not exist (bad ids) are dropped
+  if(channel < 0) return;
+
+  maps_.fill(channel, time);
+  if(channelTimes_) channelTimes_->fill(channel, time);
+  quantiles_.fill(channel, time);
+  if(lumiMoments_) lumiMoments_->fill(channel, time);
+  correlations_.fill(channel, time);
+}
+
+void TimingAccumulator::fill(int ieta, int iphi, int depth, double energy, double time) {
+  const int channel = HBHEChannelMap::channelIndex(ieta, iphi, depth);
+  const uint32_t windows = spectra_.windowMask(time);
+  spectra_.fill(channel, energy, windows);
+
+  if(counters_){
+    ++counters_->hits;
+    countWindows(windows);
+    if(energy > config_.energyCut){
+      ++counters_->passing;
+      if(depth >= 1 && depth <= 3) ++counters_->passingDepth[depth-1];
+    }
+  }
+
+  // only get timing information from rechits with high enough energy
+  if(energy > config_.energyCut) fillTiming(channel, time);
+}
+
+void TimingAccumulator::fill(const RecHitBatch& hits) {
+  const unsigned int n = hits.size();
+  channel_.resize(n);
+  windows_.resize(n);
+  passing_.resize(n);
+
+  const int *ieta = hits.ieta();
+  const int *iphi = hits.iphi();
+  const int *depth = hits.depth();
+  const float *energy = hits.energy();
+  const float *time = hits.time();
+  int *channel = channel_.data();
+  uint32_t *windows = windows_.data();
+  uint32_t *passing = passing_.data();
+
+  // one table lookup per hit gives the groups of the spectra and the channel
+  // of the maps, the time windows are compared for all hits at once
+  for(unsigned int i = 0; i < n; ++i) channel[i] = HBHEChannelMap::channelIndex(ieta[i], iphi[i], depth[i]);
+  spectra_.windowMasks(n, time, windows);
+  spectra_.fill(n, channel, energy, windows);
+
+  // the hits passing the energy cut, without branches: every hit is written
+  // but only kept if it passes. The cut is in double like in the single-hit fill.
+  const double cut = config_.energyCut;
+  unsigned int nPassing = 0;
+  for(unsigned int i = 0; i < n; ++i){
+    passing[nPassing] = i;
+    nPassing += double(energy[i]) > cut;
+  }
+
+  if(counters_){
+    counters_->hits += n;
+    for(unsigned int i = 0; i < n; ++i) countWindows(windows[i]);
+    counters_->passing += nPassing;
+    for(unsigned int k = 0; k < nPassing; ++k){
+      const int d = depth[passing[k]];
+      if(d >= 1 && d <= 3) ++counters_->passingDepth[d-1];
+    }
+  }
+
+  // the list keeps the hit order, so every histogram sees its values in the
+  // same order as with the single-hit fill (and the correlations too)
+  for(unsigned int k = 0; k < nPassing; ++k){
+    const uint32_t i = passing[k];
+    fillTiming(channel[i], time[i]);
+  }
+}
+
+void TimingAccumulator::endEvent() {
+  correlations_.endEvent();
+}
+
+void TimingAccumulator::merge(const TimingAccumulator& other) {
+  maps_.merge(other.maps_);
+  if(channelTimes_) channelTimes_->merge(*other.channelTimes_);
+  quantiles_.merge(other.quantiles_);
+
+  correlations_.merge(other.correlations_);
+
+  spectra_.merge(other.spectra_);
+}
+
+void TimingAccumulator::write(TDirectory* dir) const {
+  maps_.write(dir);
+  quantiles_.write(dir);
+  correlations_.write(dir);
+  // same names and binning the module used to book with the default groups
+  spectra_.write(dir);
+
+  if(channelTimes_) channelTimes_->write(dir);
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+
+#include "TDirectory.h"
+#include "TH1.h"
+#include "TH2.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingCorrelations.h"
+
+bool TimingCorrelations::Group::contains(int ieta, int iphi, int depth) const {
+  return ieta >= ietaLow && ieta <= ietaHigh &&
+         std::find(depths.begin(), depths.end(), depth) != depths.end() &&
+         std::find(iphis.begin(), iphis.end(), iphi) != iphis.end();
+}
+
+std::vector<TimingCorrelations::Pair> TimingCorrelations::defaultPairs() {
+  Group phi67 = {{1}, 1, 16, {67}};
+  Group phi66 = {{1}, 1, 16, {66}};
+  std::vector<Pair> pairs;
+  pairs.push_back({"Phi67Plus", phi67, phi67});
+  pairs.push_back({"66to67P", phi67, phi66});
+  return pairs;
+}
+
+TimingCorrelations::TimingCorrelations(const Axis& axis, const std::vector<Pair>& pairs) :
+  axis_(axis)
+{
+  const int nBins = axis_.nBins+2;
+  const int nShifts = 2*axis_.maxShift+1;
+
+  // every distinct group is only filled once, however many pairs it is in
+  auto groupIndex = [&](const Group& group) {
+    for(unsigned int g = 0; g < groups_.size(); ++g) if(groups_[g].group == group) return (int)g;
+    EventGroup g;
+    g.group = group;
+    g.counts.assign(nBins, 0);
+    g.touched.assign(nBins, 0);
+    g.nTouched = 0;
+    g.nHits = 0;
+    groups_.push_back(g);
+    return (int)groups_.size()-1;
+  };
+
+  for(const Pair& p : pairs){
+    PairHistograms h;
+    h.name = p.name;
+    h.a = groupIndex(p.a);
+    h.b = groupIndex(p.b);
+    h.corr.assign(nBins*nBins, 0.0);
+    h.diff.assign(nShifts+2, 0.0);
+    h.corrEntries = 0;
+    h.diffEntries = 0;
+    pairs_.push_back(h);
+  }
+
+  channelGroupBegin_.assign(HBHEChannelMap::nChannels+1, 0);
+  for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+    channelGroupBegin_[ch] = channelGroups_.size();
+    int ieta, iphi, depth;
+    HBHEChannelMap::channelCoordinates(ch, ieta, iphi, depth);
+    for(unsigned int g = 0; g < groups_.size(); ++g){
+      if(groups_[g].group.contains(ieta, iphi, depth)) channelGroups_.push_back(g);
+    }
+  }
+  channelGroupBegin_[HBHEChannelMap::nChannels] = channelGroups_.size();
+}
+
+void TimingCorrelations::addCross(const EventGroup& a, const EventGroup& b, double weight, PairHistograms& h) const {
+  const int nBins = axis_.nBins+2;
+  const int maxShift = axis_.maxShift;
+  for(unsigned int i = 0; i < a.nTouched; ++i){
+    const int binA = a.touched[i];
+    const double wA = weight*a.counts[binA];
+    double *corrRow = &h.corr[binA];
+    for(unsigned int j = 0; j < b.nTouched; ++j){
+      const int binB = b.touched[j];
+      const double w = wA*b.counts[binB];
+      corrRow[binB*nBins] += w;
+      // hits in the under- or overflow have no usable time difference
+      if(binA == 0 || binA == nBins-1 || binB == 0 || binB == nBins-1) continue;
+      const int shift = binA - binB;
+      int bin;
+      if(shift < -maxShift) bin = 0;
+      else if(shift > maxShift) bin = 2*maxShift+2;
+      else bin = shift + maxShift + 1;
+      h.diff[bin] += w;
+      h.diffEntries += w;
+    }
+  }
+}
+
+void TimingCorrelations::endEvent() {
+  const int nBins = axis_.nBins+2;
+  for(PairHistograms& h : pairs_){
+    const EventGroup& a = groups_[h.a];
+    const EventGroup& b = groups_[h.b];
+    if(a.nHits == 0 || b.nHits == 0) continue;
+    if(h.a != h.b){
+      addCross(a, b, 1.0, h);
+      h.corrEntries += double(a.nHits)*b.nHits;
+    } else {
+      // all ordered pairs of the group with half weight, minus each hit with itself
+      addCross(a, a, 0.5, h);
+      for(unsigned int i = 0; i < a.nTouched; ++i){
+        const int bin = a.touched[i];
+        const double self = 0.5*a.counts[bin];
+        h.corr[bin*nBins + bin] -= self;
+        if(bin != 0 && bin != nBins-1){
+          h.diff[axis_.maxShift+1] -= self;
+          h.diffEntries -= self;
+        }
+      }
+      h.corrEntries += 0.5*double(a.nHits)*(a.nHits-1);
+    }
+  }
+
+  for(EventGroup& g : groups_){
+    for(unsigned int i = 0; i < g.nTouched; ++i) g.counts[g.touched[i]] = 0;
+    g.nTouched = 0;
+    g.nHits = 0;
+  }
+}
+
+void TimingCorrelations::merge(const TimingCorrelations& other) {
+  for(unsigned int p = 0; p < pairs_.size(); ++p){
+    PairHistograms& h = pairs_[p];
+    const PairHistograms& o = other.pairs_[p];
+    for(unsigned int i = 0; i < h.corr.size(); ++i) h.corr[i] += o.corr[i];
+    for(unsigned int i = 0; i < h.diff.size(); ++i) h.diff[i] += o.diff[i];
+    h.corrEntries += o.corrEntries;
+    h.diffEntries += o.diffEntries;
+  }
+}
+
+void TimingCorrelations::write(TDirectory* dir) const {
+  const int nBins = axis_.nBins+2;
+  const int maxShift = axis_.maxShift;
+  const double width = (axis_.high-axis_.low)/axis_.nBins;
+  for(const PairHistograms& h : pairs_){
+    std::string diffName = "hCheckTiming"+h.name;
+    std::string corrName = "hCorrTiming"+h.name;
+    // the differences are multiples of the bin width, so they sit in the bin centres
+    TH1F *diff = new TH1F(diffName.c_str(),diffName.c_str(),2*maxShift+1,-(maxShift+0.5)*width,(maxShift+0.5)*width);
+    TH2F *corr = new TH2F(corrName.c_str(),corrName.c_str(),axis_.nBins,axis_.low,axis_.high,axis_.nBins,axis_.low,axis_.high);
+
+    for(unsigned int i = 0; i < h.diff.size(); ++i) if(h.diff[i] != 0) diff->SetBinContent(i, h.diff[i]);
+    for(int by = 0; by < nBins; ++by){
+      for(int bx = 0; bx < nBins; ++bx){
+        double c = h.corr[by*nBins + bx];
+        if(c != 0) corr->SetBinContent(corr->GetBin(bx, by), c);
+      }
+    }
+    // statistics from the bin centres, entries are the number of hit pairs
+    diff->ResetStats();
+    diff->SetEntries(h.diffEntries);
+    corr->ResetStats();
+    corr->SetEntries(h.corrEntries);
+
+    diff->SetDirectory(dir);
+    corr->SetDirectory(dir);
+  }
+}
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingInstrumentation.h"
+
+namespace {
+  // a JSON string: quotes, backslashes and control characters escaped
+  std::string jsonString(const std::string& s) {
+    std::string escaped = "\"";
+    for(char c : s){
+      if(c == '"' || c == '\\') escaped += '\\';
+      if((unsigned char)c < 0x20){
+        char code[8];
+        snprintf(code, sizeof(code), "\\u%04x", (unsigned int)c);
+        escaped += code;
+      }
+      else escaped += c;
+    }
+    return escaped+"\"";
+  }
+}
+
+void TimingHitCounters::merge(const TimingHitCounters& other) {
+  hits += other.hits;
+  passing += other.passing;
+  for(int d = 0; d < 3; ++d) passingDepth[d] += other.passingDepth[d];
+  if(windowNames.empty()) windowNames = other.windowNames;
+  windowHits.resize(windowNames.size(), 0);
+  for(unsigned int w = 0; w < windowHits.size() && w < other.windowHits.size(); ++w) windowHits[w] += other.windowHits[w];
+}
+
+TimingInstrumentation::TimingInstrumentation() :
+  stageNs_(), stageCalls_(), events_(0), eventNs_(0), maxEventNs_(0), latency_()
+{}
+
+void TimingInstrumentation::addEvent(Clock::duration elapsed) {
+  const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  ++events_;
+  eventNs_ += ns;
+  maxEventNs_ = std::max(maxEventNs_, ns);
+
+  // bin = number of bits of the time in us
+  uint64_t us = ns/1000;
+  int bin = 0;
+  while(us && bin < nLatencyBins-1){
+    us >>= 1;
+    ++bin;
+  }
+  ++latency_[bin];
+}
+
+void TimingInstrumentation::merge(const TimingInstrumentation& other) {
+  for(int s = 0; s < nStages; ++s){
+    stageNs_[s] += other.stageNs_[s];
+    stageCalls_[s] += other.stageCalls_[s];
+  }
+  events_ += other.events_;
+  eventNs_ += other.eventNs_;
+  maxEventNs_ = std::max(maxEventNs_, other.maxEventNs_);
+  for(int b = 0; b < nLatencyBins; ++b) latency_[b] += other.latency_[b];
+  counters_.merge(other.counters_);
+}
+
+const char* TimingInstrumentation::stageName(Stage stage) {
+  switch(stage){
+    case kGetRecHits: return "getRecHits";
+    case kHitLoop: return "hitLoop";
+    case kFill: return "fill";
+    case kCorrelations: return "correlations";
+    case kWrite: return "write";
+    default: return "unknown";
+  }
+}
+
+void TimingInstrumentation::writeSummary(const std::string& fileName, const std::string& module,
+                                         unsigned int streams, double jobSeconds) const {
+  FILE *out = fopen(fileName.c_str(), "w");
+  if(!out) throw std::runtime_error("TimingInstrumentation: cannot open "+fileName+" for writing");
+
+  fprintf(out, "{\n");
+  fprintf(out, "  \"module\": %s,\n", jsonString(module).c_str());
+  fprintf(out, "  \"streams\": %u,\n", streams);
+  fprintf(out, "  \"jobSeconds\": %.6f,\n", jobSeconds);
+  fprintf(out, "  \"events\": %llu,\n", (unsigned long long)events_);
+  fprintf(out, "  \"eventsPerSecond\": %.3f,\n", jobSeconds > 0 ? events_/jobSeconds : 0.0);
+
+  // total and per call, all in ns
+  fprintf(out, "  \"stages\": {\n");
+  for(int s = 0; s < nStages; ++s){
+    fprintf(out, "    \"%s\": {\"calls\": %llu, \"ns\": %llu, \"nsPerCall\": %.1f}%s\n",
+            stageName(Stage(s)), (unsigned long long)stageCalls_[s], (unsigned long long)stageNs_[s],
+            stageCalls_[s] ? double(stageNs_[s])/stageCalls_[s] : 0.0, s+1 < nStages ? "," : "");
+  }
+  fprintf(out, "  },\n");
+
+  const TimingHitCounters& c = counters_;
+  fprintf(out, "  \"hits\": {\"seen\": %llu, \"passingEnergyCut\": %llu, \"passingDepth\": [%llu, %llu, %llu],\n",
+          (unsigned long long)c.hits, (unsigned long long)c.passing, (unsigned long long)c.passingDepth[0],
+          (unsigned long long)c.passingDepth[1], (unsigned long long)c.passingDepth[2]);
+  fprintf(out, "           \"windows\": {");
+  for(unsigned int w = 0; w < c.windowNames.size() && w < c.windowHits.size(); ++w){
+    fprintf(out, "%s%s: %llu", w ? ", " : "", jsonString(c.windowNames[w]).c_str(), (unsigned long long)c.windowHits[w]);
+  }
+  fprintf(out, "}},\n");
+  fprintf(out, "  \"nsPerHit\": %.2f,\n", c.hits ? double(eventNs_)/c.hits : 0.0);
+
+  // bin k holds the events which took [lowUs[k], lowUs[k+1]) us
+  fprintf(out, "  \"eventLatency\": {\"meanNs\": %.1f, \"maxNs\": %llu,\n",
+          events_ ? double(eventNs_)/events_ : 0.0, (unsigned long long)maxEventNs_);
+  fprintf(out, "                   \"lowUs\": [0");
+  for(int b = 1; b < nLatencyBins; ++b) fprintf(out, ", %llu", 1ULL << (b-1));
+  fprintf(out, "],\n                   \"counts\": [");
+  for(int b = 0; b < nLatencyBins; ++b) fprintf(out, "%s%llu", b ? ", " : "", (unsigned long long)latency_[b]);
+  fprintf(out, "]}\n");
+  fprintf(out, "}\n");
+
+  bool failed = ferror(out);
+  if(fclose(out) != 0 || failed) throw std::runtime_error("TimingInstrumentation: write to "+fileName+" failed");
+}
@@ -0,0 +1,155 @@
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "TDirectory.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TKey.h"
+#include "TProfile2D.h"
+#include "TTree.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingMapSummary.h"
+
+namespace {
+  // "prefix<d>" with d = 1-3, -1 for any other name
+  int depthOf(const std::string& name, const char* prefix) {
+    const std::string::size_type n = std::char_traits<char>::length(prefix);
+    if(name.size() != n+1 || name.compare(0, n, prefix) != 0) return -1;
+    int d = name[n]-'1';
+    return d >= 0 && d < 3 ? d : -1;
+  }
+
+  template <class T>
+  void readOnce(TKey* key, T*& object) {
+    // keys are listed highest cycle first
+    if(!object) object = (T*)key->ReadObj();
+  }
+
+  void readTable(TKey* key, std::vector<TimingMapSummary::ChannelStats>& table) {
+    if(!table.empty()) return;
+    std::unique_ptr<TTree> tree((TTree*)key->ReadObj());
+    if(!tree) return;
+    Int_t depth, ieta, iphi;
+    Double_t time, rms, occupancy;
+    tree->SetBranchAddress("depth", &depth);
+    tree->SetBranchAddress("ieta", &ieta);
+    tree->SetBranchAddress("iphi", &iphi);
+    tree->SetBranchAddress("time", &time);
+    tree->SetBranchAddress("rms", &rms);
+    tree->SetBranchAddress("occupancy", &occupancy);
+
+    table.assign(HBHEChannelMap::nChannels, TimingMapSummary::ChannelStats{0, 0, 0});
+    for(Long64_t i = 0; i < tree->GetEntries(); ++i){
+      tree->GetEntry(i);
+      int ch = HBHEChannelMap::channelIndex(ieta, iphi, depth);
+      if(ch >= 0) table[ch] = {time, rms, occupancy};
+    }
+  }
+}
+
+bool TimingMapSummary::read(TDirectory* dir, Input& in, bool (*readChannel)(int ieta, int iphi)) {
+  TIter nextKey(dir->GetListOfKeys());
+  TKey *key;
+  while((key = (TKey*)nextKey())){
+    std::string name = key->GetName();
+    int depth, ieta, iphi, d;
+    if(sscanf(name.c_str(), "Depth%d_ieta%d_iphi%d", &depth, &ieta, &iphi) == 3){
+      int ch = HBHEChannelMap::channelIndex(ieta, iphi, depth);
+      if(ch >= 0 && readChannel && readChannel(ieta, iphi)) readOnce(key, in.channels[ch]);
+    }
+    else if((d = depthOf(name, "hHBHETiming_Depth")) >= 0) readOnce(key, in.timing[d]);
+    else if((d = depthOf(name, "occupancy_d")) >= 0) readOnce(key, in.occupancy[d]);
+    else if((d = depthOf(name, "hTimeMedian_Depth")) >= 0) readOnce(key, in.median[d]);
+    else if((d = depthOf(name, "hTimeIQR_Depth")) >= 0) readOnce(key, in.iqr[d]);
+    else if((d = depthOf(name, "hTimeTruncMean_Depth")) >= 0) readOnce(key, in.truncMean[d]);
+    else if(name == "hCorrTiming66to67P") readOnce(key, in.corr66to67);
+    else if(name == "hCorrTimingPhi67Plus") readOnce(key, in.corrPhi67Plus);
+    else if(name == "channelSummary") readTable(key, in.table);
+  }
+  for(int i = 0; i < 3; ++i) if(!in.timing[i] || !in.occupancy[i]) return false;
+  return true;
+}
+
+TimingMapSummary::TimingMapSummary() :
+  stats_(HBHEChannelMap::nChannels)
+{
+  // same names and binning as in drawTimingMaps.C, not attached to any file
+  bool addDirectory = TH1::AddDirectoryStatus();
+  TH1::AddDirectory(false);
+  for(int it = 0; it < 3; ++it){
+    std::string n = std::to_string(it+1);
+    rms[it].reset(new TH2D(("hRMS_Depth"+n).c_str(),("hRMS_Depth"+n).c_str(),59,-29.5,29.5,72,0.5,72.5));
+    err[it].reset(new TH2D(("hErr_Depth"+n).c_str(),("hErr_Depth"+n).c_str(),59,-29.5,29.5,72,0.5,72.5));
+    rmsHist[it].reset(new TH1D(("hRMS_Part"+n).c_str(),("hRMS_Part"+n).c_str(),50, 0, 25));
+    timeHist[it].reset(new TH1D(("hTime_Part"+n).c_str(),("hTime_Part"+n).c_str(),50, -10, 10));
+    timeHistHE[it].reset(new TH1D(("hTimeHE_Part"+n).c_str(),("hTimeHE_Part"+n).c_str(),50, -10, 10));
+    timeHistHB[it].reset(new TH1D(("hTimeHB_Part"+n).c_str(),("hTimeHB_Part"+n).c_str(),50, -10, 10));
+  }
+  timeAll.reset(new TH1F("hTimeAll","hTimeAll",50, -15, 15));
+  TH1::AddDirectory(addDirectory);
+}
+
+TimingMapSummary::~TimingMapSummary() {}
+
+void TimingMapSummary::fill(const Input& in) {
+  // already made by mergeTimingMaps
+  if(!in.table.empty()) stats_ = in.table;
+  else {
+    for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+      const HBHEChannelMap::Channel& c = HBHEChannelMap::channel(ch);
+      const TProfile2D *timing = in.timing[c.depth-1];
+      int bin = timing->GetBin(c.ieta+30, c.iphi);
+      stats_[ch].time = timing->GetBinContent(bin);
+      stats_[ch].rms = timing->GetBinError(bin);
+      stats_[ch].events = in.occupancy[c.depth-1]->GetBinContent(bin);
+    }
+  }
+
+  for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+    const HBHEChannelMap::Channel& c = HBHEChannelMap::channel(ch);
+    const int d = c.depth-1;
+    const ChannelStats& st = stats_[ch];
+    int bin = rms[d]->GetBin(c.ieta+30, c.iphi);
+    rms[d]->SetBinContent(bin, st.rms);
+    if(st.events > 0) err[d]->SetBinContent(bin, st.rms/std::sqrt(st.events));
+
+    if(st.time == 0) continue;
+    timeAll->Fill(st.time);
+
+    // fill by partitions
+    int part = c.phiPartition;
+    timeHist[part]->Fill(st.time);
+    if(c.subdet == 1) timeHistHE[part]->Fill(st.time);
+    else timeHistHB[part]->Fill(st.time);
+    rmsHist[part]->Fill(st.rms);
+  }
+}
+
+void TimingMapSummary::writeTable(TDirectory* dir) const {
+  TDirectory *old = gDirectory;
+  dir->cd();
+
+  Int_t depth, ieta, iphi;
+  Double_t time, rms, err, occupancy;
+  TTree *tree = new TTree("channelSummary","per-channel time, RMS, RMS/sqrt(N) and occupancy");
+  tree->Branch("depth", &depth, "depth/I");
+  tree->Branch("ieta", &ieta, "ieta/I");
+  tree->Branch("iphi", &iphi, "iphi/I");
+  tree->Branch("time", &time, "time/D");
+  tree->Branch("rms", &rms, "rms/D");
+  tree->Branch("err", &err, "err/D");
+  tree->Branch("occupancy", &occupancy, "occupancy/D");
+  for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+    const ChannelStats& st = stats_[ch];
+    if(st.events <= 0) continue;
+    HBHEChannelMap::channelCoordinates(ch, ieta, iphi, depth);
+    time = st.time;
+    rms = st.rms;
+    err = st.rms/std::sqrt(st.events);
+    occupancy = st.events;
+    tree->Fill();
+  }
+  old->cd();
+}
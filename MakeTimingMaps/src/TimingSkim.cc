@@ -0,0 +1,183 @@
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingSkim.h"
+
+namespace {
+  const char skimMagic[4] = {'H','T','S','K'};
+  const uint32_t skimVersion = 1;
+  // written as a number, so it reads back differently on a machine with the other byte order
+  const uint32_t skimByteOrder = 0x01020304;
+  const size_t headerSize = 16;
+
+  size_t padTo8(size_t n) { return (n + 7) & ~size_t(7); }
+
+  // sizes of the two column groups of a block, each padded to 8 bytes
+  size_t eventColumnsSize(uint32_t nEvents) { return padTo8(size_t(nEvents)*(4+4+8+4)); }
+  size_t hitColumnsSize(uint32_t nHits) { return padTo8(size_t(nHits)*6*4); }
+}
+
+TimingSkimWriter::TimingSkimWriter(const std::string& fileName, unsigned int blockHits) :
+  fileName_(fileName),
+  blockHits_(blockHits)
+{
+  file_ = fopen(fileName.c_str(), "wb");
+  if(!file_) throw std::runtime_error("TimingSkimWriter: cannot open "+fileName+" for writing");
+
+  char header[headerSize] = {0};
+  memcpy(header, skimMagic, 4);
+  memcpy(header+4, &skimVersion, 4);
+  memcpy(header+8, &skimByteOrder, 4);
+  writeColumn(header, headerSize);
+
+  rawId_.reserve(blockHits_);
+  energy_.reserve(blockHits_);
+  eraw_.reserve(blockHits_);
+  time_.reserve(blockHits_);
+  auxHBHE_.reserve(blockHits_);
+  aux_.reserve(blockHits_);
+}
+
+TimingSkimWriter::~TimingSkimWriter() {
+  // the modules flush explicitly at the end of the job, this only catches the
+  // case where the job is torn down early
+  try { flush(); } catch(std::exception&) {}
+  fclose(file_);
+}
+
+void TimingSkimWriter::beginEvent(uint32_t run, uint32_t lumi, uint64_t event) {
+  run_.push_back(run);
+  lumi_.push_back(lumi);
+  event_.push_back(event);
+  eventHits_.push_back(0);
+}
+
+void TimingSkimWriter::endEvent() {
+  // blocks always end on an event boundary
+  if(rawId_.size() >= blockHits_) flush();
+}
+
+void TimingSkimWriter::writeColumn(const void* data, size_t bytes) {
+  if(bytes && fwrite(data, 1, bytes, file_) != bytes) throw std::runtime_error("TimingSkimWriter: write to "+fileName_+" failed");
+}
+
+void TimingSkimWriter::flush() {
+  if(run_.empty()) return;
+
+  uint32_t n[2] = {(uint32_t)run_.size(), (uint32_t)rawId_.size()};
+  writeColumn(n, sizeof(n));
+
+  static const char zeros[8] = {0};
+  writeColumn(run_.data(), 4*n[0]);
+  writeColumn(lumi_.data(), 4*n[0]);
+  writeColumn(event_.data(), 8*n[0]);
+  writeColumn(eventHits_.data(), 4*n[0]);
+  writeColumn(zeros, eventColumnsSize(n[0]) - n[0]*20);
+
+  writeColumn(rawId_.data(), 4*size_t(n[1]));
+  writeColumn(energy_.data(), 4*size_t(n[1]));
+  writeColumn(eraw_.data(), 4*size_t(n[1]));
+  writeColumn(time_.data(), 4*size_t(n[1]));
+  writeColumn(auxHBHE_.data(), 4*size_t(n[1]));
+  writeColumn(aux_.data(), 4*size_t(n[1]));
+  writeColumn(zeros, hitColumnsSize(n[1]) - size_t(n[1])*24);
+
+  run_.clear();
+  lumi_.clear();
+  event_.clear();
+  eventHits_.clear();
+  rawId_.clear();
+  energy_.clear();
+  eraw_.clear();
+  time_.clear();
+  auxHBHE_.clear();
+  aux_.clear();
+}
+
+TimingSkimReader::TimingSkimReader(const std::string& fileName) :
+  fileName_(fileName),
+  data_(nullptr),
+  size_(0),
+  pos_(headerSize)
+{
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if(fd < 0) throw std::runtime_error("TimingSkimReader: cannot open "+fileName);
+  struct stat st;
+  if(fstat(fd, &st) != 0 || st.st_size < (off_t)headerSize){
+    close(fd);
+    throw std::runtime_error("TimingSkimReader: "+fileName+" is not a timing skim");
+  }
+  size_ = st.st_size;
+  void *m = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(m == MAP_FAILED) throw std::runtime_error("TimingSkimReader: cannot map "+fileName);
+  data_ = (const char*)m;
+  // the blocks are read front to back exactly once
+  madvise(m, size_, MADV_SEQUENTIAL);
+
+  uint32_t version, byteOrder;
+  memcpy(&version, data_+4, 4);
+  memcpy(&byteOrder, data_+8, 4);
+  if(memcmp(data_, skimMagic, 4) != 0 || version != skimVersion || byteOrder != skimByteOrder){
+    munmap(m, size_);
+    throw std::runtime_error("TimingSkimReader: "+fileName+" is not a timing skim this reader understands");
+  }
+}
+
+TimingSkimReader::~TimingSkimReader() {
+  munmap((void*)data_, size_);
+}
+
+bool TimingSkimReader::next(TimingSkimBlock& block) {
+  if(pos_ + 8 > size_) return false;
+
+  const char *p = data_ + pos_;
+  memcpy(&block.nEvents, p, 4);
+  memcpy(&block.nHits, p+4, 4);
+  size_t blockSize = 8 + eventColumnsSize(block.nEvents) + hitColumnsSize(block.nHits);
+  if(pos_ + blockSize > size_) throw std::runtime_error("TimingSkimReader: "+fileName_+" is truncated");
+  p += 8;
+
+  const uint32_t ne = block.nEvents;
+  block.run       = (const uint32_t*)p;
+  block.lumi      = (const uint32_t*)(p + 4*ne);
+  block.event     = (const uint64_t*)(p + 8*ne);
+  block.eventHits = (const uint32_t*)(p + 16*ne);
+  p += eventColumnsSize(ne);
+
+  const size_t nh = block.nHits;
+  block.rawId   = (const uint32_t*)p;
+  block.energy  = (const float*)(p + 4*nh);
+  block.eraw    = (const float*)(p + 8*nh);
+  block.time    = (const float*)(p + 12*nh);
+  block.auxHBHE = (const uint32_t*)(p + 16*nh);
+  block.aux     = (const uint32_t*)(p + 20*nh);
+
+  // the readers loop over the hits event by event, they must not run past the block
+  uint64_t sum = 0;
+  for(uint32_t e = 0; e < ne; ++e) sum += block.eventHits[e];
+  if(sum != nh) throw std::runtime_error("TimingSkimReader: "+fileName_+" is not a timing skim, its hits per event do not add up");
+
+  pos_ += blockSize;
+  return true;
+}
+
+void decodeHcalDetId(uint32_t rawId, int& ieta, int& iphi, int& depth) {
+  // same masks as DataFormats/HcalDetId, bit 24 flags the newer packing
+  if(rawId & 0x1000000){
+    iphi = rawId & 0x3FF;
+    ieta = (rawId >> 10) & 0x1FF;
+    if(!(rawId & 0x80000)) ieta = -ieta;
+    depth = (rawId >> 20) & 0xF;
+  } else {
+    iphi = rawId & 0x7F;
+    ieta = (rawId >> 7) & 0x3F;
+    if(!(rawId & 0x2000)) ieta = -ieta;
+    depth = (rawId >> 14) & 0x1F;
+  }
+}
@@ -0,0 +1,157 @@
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "TDirectory.h"
+#include "TH2.h"
+#include "TTree.h"
+
+#include "HBHETimingValidation/MakeTimingMaps/interface/TimingSummary.h"
+
+double TimingMoments::mean() const {
+  return n > 0 ? sum/n : 0.0;
+}
+
+double TimingMoments::rms() const {
+  if(n <= 0) return 0.0;
+  double m = sum/n;
+  double var = sum2/n - m*m;
+  return var > 0 ? std::sqrt(var) : 0.0;
+}
+
+void ChannelMoments::merge(const ChannelMoments& other) {
+  for(unsigned int i = 0; i < moments_.size(); ++i) moments_[i].merge(other.moments_[i]);
+}
+
+void ChannelMoments::clear() {
+  for(unsigned int i = 0; i < moments_.size(); ++i) moments_[i] = TimingMoments();
+}
+
+TimingSummary::TimingSummary(unsigned int lumisPerSection) :
+  lumisPerSection_(lumisPerSection > 0 ? lumisPerSection : 1)
+{}
+
+void TimingSummary::add(uint32_t run, uint32_t lumi, const ChannelMoments& moments) {
+  Section key = {run, sectionOf(lumi)};
+  sections_[key].merge(moments);
+}
+
+void TimingSummary::merge(const TimingSummary& other) {
+  if(other.sections_.empty()) return;
+  // an empty summary takes the section size of the first one it gets, as in read()
+  if(sections_.empty()) lumisPerSection_ = other.lumisPerSection_;
+  if(other.lumisPerSection_ != lumisPerSection_){
+    throw std::runtime_error("TimingSummary: cannot merge sections of "+std::to_string(other.lumisPerSection_)+
+                             " and "+std::to_string(lumisPerSection_)+" lumis");
+  }
+  for(auto const& s : other.sections_) sections_[s.first].merge(s.second);
+}
+
+void TimingSummary::write(TDirectory* dir) const {
+  TDirectory *old = gDirectory;
+  dir->cd();
+
+  UInt_t run, lumisPerSection = lumisPerSection_, section, first, last;
+  Int_t nChannels;
+  std::vector<UShort_t> channel(HBHEChannelMap::nChannels);
+  std::vector<Double_t> n(HBHEChannelMap::nChannels), sum(HBHEChannelMap::nChannels), sum2(HBHEChannelMap::nChannels);
+
+  TTree *tree = new TTree("timingSummary","per-channel time moments per run and lumi section");
+  tree->Branch("run", &run, "run/i");
+  tree->Branch("lumisPerSection", &lumisPerSection, "lumisPerSection/i");
+  tree->Branch("section", &section, "section/i");
+  tree->Branch("firstLumi", &first, "firstLumi/i");
+  tree->Branch("lastLumi", &last, "lastLumi/i");
+  tree->Branch("nChannels", &nChannels, "nChannels/I");
+  tree->Branch("channel", channel.data(), "channel[nChannels]/s");
+  tree->Branch("n", n.data(), "n[nChannels]/D");
+  tree->Branch("sum", sum.data(), "sum[nChannels]/D");
+  tree->Branch("sum2", sum2.data(), "sum2[nChannels]/D");
+
+  // per-run totals for the maps
+  std::map<uint32_t, ChannelMoments> runs;
+
+  for(auto const& s : sections_){
+    run = s.first.run;
+    section = s.first.section;
+    first = firstLumi(section);
+    last = lastLumi(section);
+    nChannels = 0;
+    for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+      const TimingMoments& m = s.second[ch];
+      if(m.n == 0) continue;
+      channel[nChannels] = ch;
+      n[nChannels] = m.n;
+      sum[nChannels] = m.sum;
+      sum2[nChannels] = m.sum2;
+      ++nChannels;
+    }
+    tree->Fill();
+    runs[run].merge(s.second);
+  }
+
+  for(auto const& r : runs){
+    TDirectory *runDir = dir->mkdir(("run"+std::to_string(r.first)).c_str());
+    runDir->cd();
+    TH2D *hMean[3];
+    for(int d = 0; d < 3; ++d){
+      std::string name = "hMeanTime_Depth"+std::to_string(d+1);
+      hMean[d] = new TH2D(name.c_str(),(name+" run "+std::to_string(r.first)).c_str(),59,-29.5,29.5,72,0.5,72.5);
+      // owned and written by the run directory, also with TH1::AddDirectory(kFALSE)
+      hMean[d]->SetDirectory(runDir);
+    }
+    for(int ch = 0; ch < HBHEChannelMap::nChannels; ++ch){
+      const TimingMoments& m = r.second[ch];
+      if(m.n == 0) continue;
+      int ieta, iphi, depth;
+      HBHEChannelMap::channelCoordinates(ch, ieta, iphi, depth);
+      TH2D *h = hMean[depth-1];
+      int bin = h->FindBin(ieta, iphi);
+      h->SetBinContent(bin, m.mean());
+      h->SetBinError(bin, m.rms()/std::sqrt(m.n));
+    }
+  }
+
+  old->cd();
+}
+
+bool TimingSummary::read(TDirectory* dir) {
+  TTree *tree = (TTree*)dir->Get("timingSummary");
+  if(!tree) return false;
+
+  UInt_t run, lumisPerSection, section;
+  Int_t nChannels;
+  std::vector<UShort_t> channel(HBHEChannelMap::nChannels);
+  std::vector<Double_t> n(HBHEChannelMap::nChannels), sum(HBHEChannelMap::nChannels), sum2(HBHEChannelMap::nChannels);
+  tree->SetBranchAddress("run", &run);
+  tree->SetBranchAddress("lumisPerSection", &lumisPerSection);
+  tree->SetBranchAddress("section", &section);
+  tree->SetBranchAddress("nChannels", &nChannels);
+  tree->SetBranchAddress("channel", channel.data());
+  tree->SetBranchAddress("n", n.data());
+  tree->SetBranchAddress("sum", sum.data());
+  tree->SetBranchAddress("sum2", sum2.data());
+
+  for(Long64_t i = 0; i < tree->GetEntries(); ++i){
+    tree->GetEntry(i);
+    // an empty summary takes the section size of the first file it reads
+    if(sections_.empty()) lumisPerSection_ = lumisPerSection;
+    if(lumisPerSection != lumisPerSection_){
+      throw std::runtime_error("TimingSummary: cannot merge sections of "+std::to_string(lumisPerSection)+
+                               " and "+std::to_string(lumisPerSection_)+" lumis");
+    }
+    Section key = {run, section};
+    ChannelMoments& moments = sections_[key];
+    for(int c = 0; c < nChannels; ++c){
+      if(channel[c] >= HBHEChannelMap::nChannels){
+        throw std::runtime_error("TimingSummary: channel "+std::to_string(channel[c])+" is not in HBHEChannelMap");
+      }
+      TimingMoments& m = moments[channel[c]];
+      m.n += n[c];
+      m.sum += sum[c];
+      m.sum2 += sum2[c];
+    }
+  }
+  delete tree;
+  return true;
+}
@@ -6,7 +6,14 @@
 # INPUTDIR=/afs/cern.ch/user/s/sabrandt/work/public/For_Miao/HcalTiming/CMSSW_7_6_3/src/
 INPUTDIR=../..
 
+# with the package built, drawTimingMapsBatch makes the same plots for all the runs at once,
+# in run<N>/ for every run<N>.root
+if which drawTimingMapsBatch > /dev/null 2>&1; then
+  drawTimingMapsBatch ${INPUTDIR}/run*.root
+  exit
+fi
+
 # function inputs: drawPlots(inputFileName, outputFolderName, datasetDescriptionForPlots)
 root -l -q drawTimingMaps.C+\(\"${INPUTDIR}/run251721.root\",\"run251721\",\"run251721\"\)
 
-rm *.so *.d *.pcm
\ No newline at end of file
+rm *.so *.d *.pcm